@@ -2,6 +2,7 @@
 #include <debug.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/thread.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
@@ -21,6 +22,7 @@ input_putc (uint8_t key) {
 
 	intq_putc (&buffer, key);
 	serial_notify ();
+	thread_poll_wake ();
 }
 
 /* Retrieves a key from the input buffer.
@@ -38,6 +40,15 @@ input_getc (void) {
 	return key;
 }
 
+/* Returns true if the input buffer is empty,
+   false otherwise.
+   Interrupts must be off. */
+bool
+input_empty (void) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	return intq_empty (&buffer);
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -1,5 +1,6 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <stdio.h>
 #include "devices/input.h"
 #include "devices/intq.h"
 #include "devices/timer.h"
@@ -37,6 +38,15 @@
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable the receive and transmit FIFOs. */
+#define FCR_CLEAR_RECV 0x02     /* Discard the receive FIFO's contents. */
+#define FCR_CLEAR_XMIT 0x04     /* Discard the transmit FIFO's contents. */
+#define FCR_TRIGGER_1 0x00      /* Receive interrupt after 1 byte. */
+
+/* Size of the 16550A transmit FIFO, in bytes. */
+#define XMIT_FIFO_SIZE 16
+
 /* Line Control Register bits. */
 #define LCR_N81 0x03            /* No parity, 8 data bits, 1 stop bit. */
 #define LCR_DLAB 0x80           /* Divisor Latch Access Bit (DLAB). */
@@ -54,8 +64,13 @@ static enum { UNINIT, POLL, QUEUE } mode;
 /* Data to be transmitted. */
 static struct intq txq;
 
+/* Statistics. */
+static long long xmit_intr_cnt;   /* # of transmit interrupts that sent. */
+static long long xmit_byte_cnt;   /* # of bytes sent from interrupts. */
+
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
+static void putc_queue (uint8_t, enum intr_level);
 static void write_ier (void);
 static intr_handler_func serial_interrupt;
 
@@ -67,7 +82,7 @@ static void
 init_poll (void) {
 	ASSERT (mode == UNINIT);
 	outb (IER_REG, 0);                    /* Turn off all interrupts. */
-	outb (FCR_REG, 0);                    /* Disable FIFO. */
+	outb (FCR_REG, 0);                    /* Disable FIFO for now. */
 	set_serial (115200);                  /* 115.2 kbps, N-8-1. */
 	outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
 	intq_init (&txq);
@@ -88,6 +103,13 @@ serial_init_queue (void) {
 	intr_register_ext (0x20 + 4, serial_interrupt, "serial");
 	mode = QUEUE;
 	old_level = intr_disable ();
+
+	/* With the FIFOs on, each transmit interrupt can hand the
+	   UART XMIT_FIFO_SIZE bytes instead of one.  The receive
+	   trigger stays at one byte, so input still arrives a byte
+	   at a time as before. */
+	outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RECV | FCR_CLEAR_XMIT
+			| FCR_TRIGGER_1);
 	write_ier ();
 	intr_set_level (old_level);
 }
@@ -106,16 +128,29 @@ serial_putc (uint8_t byte) {
 	} else {
 		/* Otherwise, queue a byte and update the interrupt enable
 		   register. */
-		if (old_level == INTR_OFF && intq_full (&txq)) {
-			/* Interrupts are off and the transmit queue is full.
-			   If we wanted to wait for the queue to empty,
-			   we'd have to reenable interrupts.
-			   That's impolite, so we'll send a character via
-			   polling instead. */
-			putc_poll (intq_getc (&txq));
-		}
+		putc_queue (byte, old_level);
+		write_ier ();
+	}
+
+	intr_set_level (old_level);
+}
 
-		intq_putc (&txq, byte);
+/* Sends the SIZE bytes in BUFFER to the serial port.  Unlike
+   calling serial_putc() for each byte, this queues as much as
+   fits in the transmit queue with interrupts off throughout and
+   only updates the interrupt enable register once. */
+void
+serial_putbuf (const uint8_t *buffer, size_t size) {
+	enum intr_level old_level = intr_disable ();
+
+	if (mode != QUEUE) {
+		if (mode == UNINIT)
+			init_poll ();
+		while (size-- > 0)
+			putc_poll (*buffer++);
+	} else {
+		while (size-- > 0)
+			putc_queue (*buffer++, old_level);
 		write_ier ();
 	}
 
@@ -143,6 +178,17 @@ serial_notify (void) {
 		write_ier ();
 }
 
+/* Prints serial statistics. */
+void
+serial_print_stats (void) {
+	if (xmit_intr_cnt == 0)
+		return;
+	printf ("Serial: %lld bytes sent in %lld interrupts, "
+			"%lld.%02lld bytes/interrupt\n",
+			xmit_byte_cnt, xmit_intr_cnt, xmit_byte_cnt / xmit_intr_cnt,
+			xmit_byte_cnt * 100 / xmit_intr_cnt % 100);
+}
+
 /* Configures the serial port for BPS bits per second. */
 static void
 set_serial (int bps) {
@@ -193,6 +239,29 @@ putc_poll (uint8_t byte) {
 	outb (THR_REG, byte);
 }
 
+/* Adds BYTE to the transmit queue.  OLD_LEVEL is the interrupt
+   level the caller had before disabling interrupts. */
+static void
+putc_queue (uint8_t byte, enum intr_level old_level) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (intq_full (&txq)) {
+		if (old_level == INTR_OFF) {
+			/* Interrupts are off and the transmit queue is full.
+			   If we wanted to wait for the queue to empty,
+			   we'd have to reenable interrupts.
+			   That's impolite, so we'll send a character via
+			   polling instead. */
+			putc_poll (intq_getc (&txq));
+		} else {
+			/* We are about to sleep until the queue drains, so
+			   make sure the transmit interrupt is on. */
+			write_ier ();
+		}
+	}
+	intq_putc (&txq, byte);
+}
+
 /* Serial interrupt handler. */
 static void
 serial_interrupt (struct intr_frame *f UNUSED) {
@@ -205,10 +274,16 @@ serial_interrupt (struct intr_frame *f UNUSED) {
 	while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
 		input_putc (inb (RBR_REG));
 
-	/* As long as we have a byte to transmit, and the hardware is
-	   ready to accept a byte for transmission, transmit a byte. */
-	while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0)
-		outb (THR_REG, intq_getc (&txq));
+	/* THRE means the whole transmit FIFO is empty, so refill it
+	   with as many bytes as it holds. */
+	if (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) {
+		int n;
+
+		for (n = 0; n < XMIT_FIFO_SIZE && !intq_empty (&txq); n++)
+			outb (THR_REG, intq_getc (&txq));
+		xmit_intr_cnt++;
+		xmit_byte_cnt += n;
+	}
 
 	/* Update interrupt enable register based on queue status. */
 	write_ier ();
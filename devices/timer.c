@@ -102,6 +102,19 @@ timer_sleep (int64_t ticks) {
 	thread_sleep_until(wake_tick);
 }
 
+/* Blocks until thread_poll_wake() has been called since poll
+   sequence number SEQ was read, or until timer tick WAKE_TICK,
+   whichever comes first.  WAKE_TICK may be INT64_MAX for no
+   limit. */
+// P2
+void
+timer_poll_wait (uint64_t seq, int64_t wake_tick) {
+	if (wake_tick < next_wake_tick) {
+		next_wake_tick = wake_tick;
+	}
+	thread_poll_wait(seq, wake_tick);
+}
+
 /* Suspends execution for approximately MS milliseconds. */
 void
 timer_msleep (int64_t ms) {
@@ -1,11 +1,15 @@
 #include "filesys/inode.h"
 #include <list.h>
 #include <debug.h>
+#include <radix.h>
 #include <round.h>
 #include <string.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -34,8 +38,22 @@ struct inode {
 	bool removed;                       /* True if deleted, false otherwise. */
 	int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
 	struct inode_disk data;             /* Inode content. */
+	struct radix_tree text_pages;       /* Cached text pages, by page number. */
+	uint64_t version;                   /* Changes on every write. */
 };
 
+/* A read-only page of an executable, shared by every process that
+ * maps it.  The cache holds one reference to KPAGE, and each
+ * mapping holds another.  KPAGE is null once evicted. */
+struct text_page {
+	void *kpage;                        /* Frame, from the user pool. */
+	size_t read_bytes;                  /* Bytes read from the file. */
+};
+
+static void drop_text_pages (struct inode *, uint64_t first, uint64_t last);
+static size_t evict_text_pages (void);
+static size_t reclaim_text_pages (void);
+
 /* Returns the disk sector that contains byte offset POS within
  * INODE.
  * Returns -1 if INODE does not contain data for a byte at offset
@@ -53,10 +71,23 @@ byte_to_sector (const struct inode *inode, off_t pos) {
  * returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Protects every inode's TEXT_PAGES. */
+static struct lock text_lock;
+
+/* Last version handed out to an inode. */
+static uint64_t last_version;
+
+/* Versions of inodes that were closed but not removed, by sector,
+ * so that reopening an unchanged inode gives back its version. */
+static struct radix_tree closed_versions;
+
 /* Initializes the inode module. */
 void
 inode_init (void) {
 	list_init (&open_inodes);
+	lock_init (&text_lock);
+	radix_init (&closed_versions);
+	palloc_set_reclaim (reclaim_text_pages);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -70,6 +101,7 @@ inode_create (disk_sector_t sector, off_t length) {
 	bool success = false;
 
 	ASSERT (length >= 0);
+	radix_delete (&closed_versions, sector);
 
 	/* If this assertion fails, the inode structure is not exactly
 	 * one sector in size, and you should fix that. */
@@ -103,6 +135,7 @@ struct inode *
 inode_open (disk_sector_t sector) {
 	struct list_elem *e;
 	struct inode *inode;
+	void *version;
 
 	/* Check whether this inode is already open. */
 	for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
@@ -125,6 +158,9 @@ inode_open (disk_sector_t sector) {
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
 	inode->removed = false;
+	radix_init (&inode->text_pages);
+	version = radix_delete (&closed_versions, sector);
+	inode->version = version != NULL ? (uint64_t) version : ++last_version;
 	disk_read (filesys_disk, inode->sector, &inode->data);
 	return inode;
 }
@@ -137,6 +173,16 @@ inode_reopen (struct inode *inode) {
 	return inode;
 }
 
+/* Returns INODE's version, which is different after every write
+ * to INODE's data.  Versions are never reused, even by other
+ * inodes, and survive closing and reopening INODE, so anything
+ * derived from INODE's data may be cached by sector as long as
+ * the version stays the same. */
+uint64_t
+inode_version (const struct inode *inode) {
+	return inode->version;
+}
+
 /* Returns INODE's inode number. */
 disk_sector_t
 inode_get_inumber (const struct inode *inode) {
@@ -156,13 +202,16 @@ inode_close (struct inode *inode) {
 	if (--inode->open_cnt == 0) {
 		/* Remove from inode list and release lock. */
 		list_remove (&inode->elem);
+		drop_text_pages (inode, 0, UINT64_MAX);
 
 		/* Deallocate blocks if removed. */
 		if (inode->removed) {
 			free_map_release (inode->sector, 1);
 			free_map_release (inode->data.start,
 					bytes_to_sectors (inode->data.length)); 
-		}
+		} else
+			radix_insert (&closed_versions, inode->sector,
+					(void *) inode->version);
 
 		free (inode); 
 	}
@@ -239,6 +288,9 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
 	if (inode->deny_write_cnt)
 		return 0;
+	if (size > 0)
+		drop_text_pages (inode, offset / PGSIZE, (offset + size - 1) / PGSIZE);
+	inode->version = ++last_version;
 
 	while (size > 0) {
 		/* Sector to write, starting byte offset within sector. */
@@ -311,3 +363,124 @@ off_t
 inode_length (const struct inode *inode) {
 	return inode->data.length;
 }
+
+/* Returns a frame holding the page of INODE at OFFSET, which must
+ * be page-aligned: READ_BYTES bytes of the file followed by zeros.
+ * The frame comes from a cache of read-only text pages, so that
+ * every process running the same executable maps the same frames.
+ * The caller gets its own reference to the frame, which it drops
+ * with palloc_free_page(), and must never write to it.  Returns a
+ * null pointer if memory or the read fails. */
+void *
+inode_get_text_page (struct inode *inode, off_t offset, size_t read_bytes) {
+	uint64_t pg = offset / PGSIZE;
+	struct text_page *tp;
+	void *kpage;
+
+	ASSERT (offset % PGSIZE == 0);
+	ASSERT (read_bytes <= PGSIZE);
+
+	lock_acquire (&text_lock);
+	tp = radix_lookup (&inode->text_pages, pg);
+	if (tp != NULL && tp->kpage != NULL && tp->read_bytes == read_bytes) {
+		palloc_ref_page (tp->kpage);
+		lock_release (&text_lock);
+		return tp->kpage;
+	}
+
+	/* If the user pool is dry, palloc reclaims unused text pages,
+	   possibly including TP's. */
+	kpage = palloc_get_page (PAL_USER);
+	if (kpage == NULL
+			|| inode_read_at (inode, kpage, read_bytes, offset) != (off_t) read_bytes) {
+		palloc_free_page (kpage);
+		lock_release (&text_lock);
+		return NULL;
+	}
+	memset (kpage + read_bytes, 0, PGSIZE - read_bytes);
+
+	if (tp == NULL && (tp = malloc (sizeof *tp)) != NULL) {
+		tp->kpage = NULL;
+		if (!radix_insert (&inode->text_pages, pg, tp)) {
+			free (tp);
+			tp = NULL;
+		}
+	}
+
+	/* A new or evicted entry takes this page.  A page cached with
+	   other contents, from a segment that ends elsewhere in it,
+	   stays; this one is just not shared. */
+	if (tp != NULL && tp->kpage == NULL) {
+		tp->kpage = kpage;
+		tp->read_bytes = read_bytes;
+		palloc_ref_page (kpage);
+	}
+	lock_release (&text_lock);
+	return kpage;
+}
+
+/* Drops INODE's cached text pages numbered FIRST through LAST.
+ * Frames still mapped stay with their processes until they unmap
+ * them. */
+static void
+drop_text_pages (struct inode *inode, uint64_t first, uint64_t last) {
+	struct radix_iter i;
+	struct text_page *tp;
+
+	if (radix_empty (&inode->text_pages))
+		return;
+
+	lock_acquire (&text_lock);
+	radix_iter_init (&i, &inode->text_pages, first, last);
+	while ((tp = radix_iter_next (&i)) != NULL) {
+		radix_delete (&inode->text_pages, i.index);
+		palloc_free_page (tp->kpage);
+		free (tp);
+	}
+	lock_release (&text_lock);
+}
+
+/* Frees the frames of every cached text page that no process maps.
+ * The entries stay, empty, until their page is read again, so this
+ * neither allocates nor frees memory other than those frames.
+ * Must be called with TEXT_LOCK held.  Returns the number of frames
+ * freed. */
+static size_t
+evict_text_pages (void) {
+	struct list_elem *e;
+	size_t cnt = 0;
+
+	ASSERT (lock_held_by_current_thread (&text_lock));
+	for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+			e = list_next (e)) {
+		struct inode *inode = list_entry (e, struct inode, elem);
+		struct radix_iter i;
+		struct text_page *tp;
+
+		radix_iter_init (&i, &inode->text_pages, 0, UINT64_MAX);
+		while ((tp = radix_iter_next (&i)) != NULL)
+			if (tp->kpage != NULL && palloc_page_refs (tp->kpage) == 1) {
+				palloc_free_page (tp->kpage);
+				tp->kpage = NULL;
+				cnt++;
+			}
+	}
+	return cnt;
+}
+
+/* Evicts unused text pages for palloc, when a pool runs dry.  Gives
+ * up if another thread is using the cache, because that thread may
+ * be waiting for a lock that the caller holds.  Returns the number
+ * of frames freed. */
+static size_t
+reclaim_text_pages (void) {
+	bool held = lock_held_by_current_thread (&text_lock);
+	size_t cnt;
+
+	if (!held && !lock_try_acquire (&text_lock))
+		return 0;
+	cnt = evict_text_pages ();
+	if (!held)
+		lock_release (&text_lock);
+	return cnt;
+}
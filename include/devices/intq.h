@@ -17,8 +17,10 @@
    protect kernel threads from one another, not from interrupt
    handlers. */
 
-/* Queue buffer size, in bytes. */
-#define INTQ_BUFSIZE 64
+/* Queue buffer size, in bytes.  Large enough that a full
+   putbuf() chunk of console output fits without the writer
+   sleeping once per byte as the serial port drains it. */
+#define INTQ_BUFSIZE 1024
 
 /* A circular queue of bytes. */
 struct intq {
@@ -1,8 +1,16 @@
 #ifndef __LIB_KERNEL_CONSOLE_H
 #define __LIB_KERNEL_CONSOLE_H
 
+#include <stddef.h>
+
+/* Bytes of recent output kept in the kernel log. */
+#define CONSOLE_LOG_SIZE (16 * 1024)
+
 void console_init (void);
+void console_start_drain (void);
 void console_panic (void);
+void console_flush (void);
+size_t console_read_log (char *, size_t);
 void console_print_stats (void);
 
 #endif /* lib/kernel/console.h */
@@ -0,0 +1,69 @@
+#ifndef __LIB_KERNEL_ITREE_H
+#define __LIB_KERNEL_ITREE_H
+
+/* Interval tree.
+ *
+ * A red-black tree of half-open ranges [START, END), such as the
+ * address ranges of memory mappings, ordered by START.  Each node
+ * also records the greatest END in its subtree, which lets a
+ * search for the ranges that overlap a query skip every subtree
+ * that ends before the query begins.  Finding the first
+ * overlapping range takes O(lg n) time, and each further one
+ * takes amortized O(lg n) time.
+ *
+ * As with rbtree.h, nodes are embedded in the structures they
+ * index, and itree_entry converts a struct itree_node back to the
+ * structure that contains it.  Ranges may overlap each other.
+ *
+ * Iteration idiom, visiting every range that overlaps
+ * [START, END):
+ *
+ * struct itree_node *n;
+ *
+ * for (n = itree_first (t, start, end); n != NULL;
+ *      n = itree_next (n, start, end))
+ *   {
+ *     struct foo *f = itree_entry (n, struct foo, node);
+ *     ...do something with f...
+ *   }
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rbtree.h"
+
+/* Interval tree node. */
+struct itree_node {
+	struct rb_node rb_node;     /* Red-black tree node. */
+	uint64_t start;             /* First value in the range. */
+	uint64_t end;               /* One past the last value. */
+	uint64_t max_end;           /* Greatest `end' in this subtree. */
+};
+
+/* Converts pointer to interval tree node ITREE_NODE into a
+ * pointer to the structure that ITREE_NODE is embedded inside.
+ * Supply the name of the outer structure STRUCT and the member
+ * name MEMBER of the tree node. */
+#define itree_entry(ITREE_NODE, STRUCT, MEMBER)                 \
+	((STRUCT *) ((uint8_t *) &(ITREE_NODE)->start           \
+		- offsetof (STRUCT, MEMBER.start)))
+
+/* Interval tree. */
+struct itree {
+	struct rb_tree rb_tree;     /* Underlying red-black tree. */
+};
+
+void itree_init (struct itree *);
+void itree_insert (struct itree *, struct itree_node *,
+		uint64_t start, uint64_t end);
+void itree_remove (struct itree *, struct itree_node *);
+
+struct itree_node *itree_first (struct itree *, uint64_t start, uint64_t end);
+struct itree_node *itree_next (struct itree_node *, uint64_t start,
+		uint64_t end);
+
+size_t itree_size (struct itree *);
+bool itree_empty (struct itree *);
+
+#endif /* lib/kernel/itree.h */
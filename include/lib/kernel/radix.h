@@ -0,0 +1,104 @@
+#ifndef __LIB_KERNEL_RADIX_H
+#define __LIB_KERNEL_RADIX_H
+
+/* Radix tree.
+ *
+ * Maps 64-bit indexes, such as page numbers, file page offsets
+ * or sector numbers, to non-null pointers.  Each node of the tree
+ * splits the index into RADIX_SLOTS ways, six bits at a time, so
+ * a lookup touches one node per level and the tree is only as
+ * tall as the largest index requires.  Nodes exist only for
+ * ranges that hold entries, which keeps sparse maps compact.
+ *
+ * Entries are visited in index order, so the tree also answers
+ * "the next entries at or after this index" questions: gang
+ * lookups fill an array with up to N such entries, and iterators
+ * walk every entry in a range.
+ *
+ * Each entry also carries RADIX_TAG_CNT tag bits, such as "dirty"
+ * or "under writeback".  Every node summarizes the tags below it,
+ * so finding the tagged entries skips untagged subtrees entirely.
+ *
+ * The tree allocates its nodes with malloc().  It does no
+ * locking of its own.
+ *
+ * Iteration idiom, visiting every entry with an index in
+ * [FIRST, LAST]:
+ *
+ * struct radix_iter i;
+ * void *item;
+ *
+ * radix_iter_init (&i, tree, first, last);
+ * while ((item = radix_iter_next (&i)) != NULL)
+ *   {
+ *     ...do something with ITEM, whose index is i.index...
+ *   }
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Index bits consumed by each level, and slots per node. */
+#define RADIX_SHIFT 6
+#define RADIX_SLOTS (1 << RADIX_SHIFT)
+
+/* Tags. */
+#define RADIX_TAG_CNT 2
+enum radix_tag {
+	RADIX_TAG_DIRTY,            /* Entry has been modified. */
+	RADIX_TAG_WRITEBACK         /* Entry is being written back. */
+};
+
+struct radix_node;
+
+/* Radix tree. */
+struct radix_tree {
+	struct radix_node *root;    /* Root node, or null if empty. */
+	size_t cnt;                 /* Number of entries. */
+};
+
+/* Radix tree iterator. */
+struct radix_iter {
+	struct radix_tree *tree;    /* The tree. */
+	uint64_t index;             /* Index of the current entry. */
+	uint64_t next;              /* Index to search from next. */
+	uint64_t last;              /* Last index to visit. */
+	int tag;                    /* Tag to require, or -1 for none. */
+	bool done;                  /* Range exhausted? */
+};
+
+/* Performs some operation on ITEM, stored at INDEX. */
+typedef void radix_action_func (void *item, uint64_t index);
+
+/* Basic life cycle. */
+void radix_init (struct radix_tree *);
+void radix_destroy (struct radix_tree *, radix_action_func *);
+
+/* Search, insertion, deletion. */
+bool radix_insert (struct radix_tree *, uint64_t index, void *item);
+void *radix_lookup (struct radix_tree *, uint64_t index);
+void *radix_delete (struct radix_tree *, uint64_t index);
+
+/* Tags. */
+void radix_tag_set (struct radix_tree *, uint64_t index, enum radix_tag);
+void radix_tag_clear (struct radix_tree *, uint64_t index, enum radix_tag);
+bool radix_tag_get (struct radix_tree *, uint64_t index, enum radix_tag);
+bool radix_tagged (struct radix_tree *, enum radix_tag);
+
+/* Ordered scans. */
+size_t radix_gang_lookup (struct radix_tree *, uint64_t first,
+		void **items, size_t max);
+size_t radix_gang_lookup_tag (struct radix_tree *, uint64_t first,
+		void **items, size_t max, enum radix_tag);
+void radix_iter_init (struct radix_iter *, struct radix_tree *,
+		uint64_t first, uint64_t last);
+void radix_iter_init_tag (struct radix_iter *, struct radix_tree *,
+		uint64_t first, uint64_t last, enum radix_tag);
+void *radix_iter_next (struct radix_iter *);
+
+/* Information. */
+size_t radix_size (struct radix_tree *);
+bool radix_empty (struct radix_tree *);
+
+#endif /* lib/kernel/radix.h */
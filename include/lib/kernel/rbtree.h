@@ -0,0 +1,116 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * A balanced binary search tree that keeps its elements in
+ * order and finds, inserts and removes them in O(lg n) time.
+ * Like the linked list in list.h, the tree does not allocate
+ * memory: each structure that can be in a tree embeds a struct
+ * rb_node member, and rb_entry converts a struct rb_node back to
+ * the structure that contains it.  Refer to lib/kernel/list.h
+ * for a detailed explanation of the technique.
+ *
+ * Elements are ordered by a LESS function given to rb_init().
+ * Equal elements are allowed; a new element is placed after any
+ * that compare equal to it, so elements inserted in order come
+ * back out in that order.
+ *
+ * A tree can be augmented with data that summarizes each
+ * subtree, such as the greatest end address of the intervals
+ * below a node (see itree.h).  Pass an UPDATE function to
+ * rb_init_augmented(); it must recompute a node's data from the
+ * node itself and its children, and the tree calls it on every
+ * node whose subtree changes.
+ *
+ * Example:
+ *
+ * struct timer
+ *   {
+ *     int64_t wakeup;
+ *     struct rb_node node;
+ *   };
+ *
+ * static bool
+ * timer_less (const struct rb_node *a, const struct rb_node *b,
+ *             void *aux UNUSED)
+ * {
+ *   return rb_entry (a, struct timer, node)->wakeup
+ *          < rb_entry (b, struct timer, node)->wakeup;
+ * }
+ *
+ * ...
+ *   struct rb_tree timers;
+ *
+ *   rb_init (&timers, timer_less, NULL);
+ *   rb_insert (&timers, &t->node);
+ *   ...
+ *   struct rb_node *first = rb_first (&timers);
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Red-black tree node. */
+struct rb_node {
+	struct rb_node *parent;     /* Parent, or null for the root. */
+	struct rb_node *left;       /* Left child, or null. */
+	struct rb_node *right;      /* Right child, or null. */
+	bool red;                   /* Red or black? */
+};
+
+/* Converts pointer to tree node RB_NODE into a pointer to the
+ * structure that RB_NODE is embedded inside.  Supply the name of
+ * the outer structure STRUCT and the member name MEMBER of the
+ * tree node. */
+#define rb_entry(RB_NODE, STRUCT, MEMBER)                       \
+	((STRUCT *) ((uint8_t *) &(RB_NODE)->parent             \
+		- offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree nodes A and B, given auxiliary
+ * data AUX.  Returns true if A is less than B, or false if A is
+ * greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_node *a,
+		const struct rb_node *b,
+		void *aux);
+
+/* Recomputes the augmented data of node N from N and its
+ * children, given auxiliary data AUX. */
+typedef void rb_update_func (struct rb_node *n, void *aux);
+
+/* Red-black tree. */
+struct rb_tree {
+	struct rb_node *root;       /* Root node, or null if empty. */
+	size_t size;                /* Number of nodes. */
+	rb_less_func *less;         /* Comparison function. */
+	rb_update_func *update;     /* Augmentation function, or null. */
+	void *aux;                  /* Auxiliary data for `less' and `update'. */
+};
+
+/* Basic life cycle. */
+void rb_init (struct rb_tree *, rb_less_func *, void *aux);
+void rb_init_augmented (struct rb_tree *, rb_less_func *, rb_update_func *,
+		void *aux);
+
+/* Insertion and removal. */
+void rb_insert (struct rb_tree *, struct rb_node *);
+void rb_remove (struct rb_tree *, struct rb_node *);
+
+/* Search.  KEY is a node, usually in a structure on the stack,
+ * that holds the value to look for. */
+struct rb_node *rb_find (struct rb_tree *, const struct rb_node *key);
+struct rb_node *rb_lower_bound (struct rb_tree *, const struct rb_node *key);
+struct rb_node *rb_upper_bound (struct rb_tree *, const struct rb_node *key);
+
+/* Traversal, in order. */
+struct rb_node *rb_first (struct rb_tree *);
+struct rb_node *rb_last (struct rb_tree *);
+struct rb_node *rb_next (struct rb_node *);
+struct rb_node *rb_prev (struct rb_node *);
+
+/* Information. */
+size_t rb_size (struct rb_tree *);
+bool rb_empty (struct rb_tree *);
+
+#endif /* lib/kernel/rbtree.h */
@@ -0,0 +1,118 @@
+#ifndef __LIB_KERNEL_RHASH_H
+#define __LIB_KERNEL_RHASH_H
+
+/* Open-addressing hash table.
+ *
+ * This is an alternative to the chained table in hash.h with the
+ * same intrusive interface: each structure that can be in the
+ * table embeds a struct rhash_elem, and rhash_entry converts a
+ * struct rhash_elem back to the structure that contains it.
+ *
+ * Elements live directly in an array of slots, each holding an
+ * element's hash value next to a pointer to the element, so a
+ * probe walks consecutive memory and only calls the LESS function
+ * on a full hash match.  Collisions are resolved by Robin Hood
+ * linear probing: an insertion takes over the slot of any element
+ * that is closer to its home slot than the one being inserted.
+ * This keeps probe sequences short and lets a failed lookup stop
+ * as soon as it meets an element nearer to home than itself.
+ * Deletion shifts the following elements back by one slot, so no
+ * tombstones accumulate.
+ *
+ * The table resizes incrementally.  When it grows or shrinks, a
+ * new slot array is allocated and the old one is kept alongside
+ * it.  Each later insertion or deletion moves a few slots' worth
+ * of elements from the old array to the new one, and lookups
+ * search both arrays until the old one is empty.  No single
+ * operation rehashes the whole table.
+ *
+ * The hash functions in hash.h, such as hash_bytes() and
+ * hash_int(), are suitable for use with this table. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Hash element.  The table keeps everything it needs in its own
+ * slots, so this only marks where the element is embedded. */
+struct rhash_elem {
+};
+
+/* Converts pointer to hash element RHASH_ELEM into a pointer to
+ * the structure that RHASH_ELEM is embedded inside.  Supply the
+ * name of the outer structure STRUCT and the member name MEMBER
+ * of the hash element. */
+#define rhash_entry(RHASH_ELEM, STRUCT, MEMBER)                 \
+	((STRUCT *) ((uint8_t *) (RHASH_ELEM)                   \
+		- offsetof (STRUCT, MEMBER)))
+
+/* Computes and returns the hash value for hash element E, given
+ * auxiliary data AUX. */
+typedef uint64_t rhash_hash_func (const struct rhash_elem *e, void *aux);
+
+/* Compares the value of two hash elements A and B, given
+ * auxiliary data AUX.  Returns true if A is less than B, or
+ * false if A is greater than or equal to B. */
+typedef bool rhash_less_func (const struct rhash_elem *a,
+		const struct rhash_elem *b,
+		void *aux);
+
+/* Performs some operation on hash element E, given auxiliary
+ * data AUX. */
+typedef void rhash_action_func (struct rhash_elem *e, void *aux);
+
+/* A slot in a table. */
+struct rhash_slot {
+	uint64_t hash;              /* Hash value, or 0 if never used. */
+	struct rhash_elem *elem;    /* Element, or null if empty. */
+};
+
+/* An array of slots. */
+struct rhash_table {
+	size_t slot_cnt;            /* Number of slots, a power of 2. */
+	size_t elem_cnt;            /* Number of elements in slots. */
+	struct rhash_slot *slots;   /* Array of `slot_cnt' slots. */
+};
+
+/* Hash table. */
+struct rhash {
+	size_t elem_cnt;            /* Number of elements in table. */
+	struct rhash_table cur;     /* Slots that take new elements. */
+	struct rhash_table old;     /* Slots being emptied into `cur'. */
+	size_t move_idx;            /* Next slot of `old' to move. */
+	rhash_hash_func *hash;      /* Hash function. */
+	rhash_less_func *less;      /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `hash' and `less'. */
+};
+
+/* A hash table iterator. */
+struct rhash_iterator {
+	struct rhash *hash;         /* The hash table. */
+	struct rhash_table *table;  /* Slot array being visited. */
+	size_t idx;                 /* Next slot to visit in `table'. */
+	struct rhash_elem *elem;    /* Current hash element. */
+};
+
+/* Basic life cycle. */
+bool rhash_init (struct rhash *, rhash_hash_func *, rhash_less_func *,
+		void *aux);
+void rhash_clear (struct rhash *, rhash_action_func *);
+void rhash_destroy (struct rhash *, rhash_action_func *);
+
+/* Search, insertion, deletion. */
+struct rhash_elem *rhash_insert (struct rhash *, struct rhash_elem *);
+struct rhash_elem *rhash_replace (struct rhash *, struct rhash_elem *);
+struct rhash_elem *rhash_find (struct rhash *, struct rhash_elem *);
+struct rhash_elem *rhash_delete (struct rhash *, struct rhash_elem *);
+
+/* Iteration. */
+void rhash_apply (struct rhash *, rhash_action_func *);
+void rhash_first (struct rhash_iterator *, struct rhash *);
+struct rhash_elem *rhash_next (struct rhash_iterator *);
+struct rhash_elem *rhash_cur (struct rhash_iterator *);
+
+/* Information. */
+size_t rhash_size (struct rhash *);
+bool rhash_empty (struct rhash *);
+
+#endif /* lib/kernel/rhash.h */
@@ -0,0 +1,38 @@
+#ifndef __LIB_MEMSTAT_H
+#define __LIB_MEMSTAT_H
+
+#include <stddef.h>
+
+/* Memory usage report filled in by the memstat system call.
+   Shared between the kernel and user programs. */
+
+/* Maximum number of malloc() descriptors reported. */
+#define MEMSTAT_DESC_CNT 10
+
+/* Occupancy of one malloc() descriptor. */
+struct memstat_desc {
+	size_t block_size;          /* Size of each block in bytes. */
+	size_t arenas;              /* Arenas (pages) owned. */
+	size_t blocks;              /* Blocks handed out. */
+	size_t waste;               /* Arena bytes not handed out. */
+};
+
+struct memstat {
+	/* Page allocator, in pages. */
+	size_t kern_used;           /* Kernel pool pages in use. */
+	size_t kern_free;           /* Kernel pool pages free. */
+	size_t user_used;           /* User pool pages in use. */
+	size_t user_free;           /* User pool pages free. */
+
+	/* Kernel malloc(). */
+	size_t desc_cnt;            /* Valid entries in DESCS. */
+	struct memstat_desc descs[MEMSTAT_DESC_CNT];
+	size_t big_blocks;          /* Blocks too big for a descriptor. */
+	size_t big_pages;           /* Pages held by those blocks. */
+
+	/* Calling process. */
+	size_t rss;                 /* Resident user pages. */
+	size_t pt_pages;            /* Page table pages, including PML4. */
+};
+
+#endif /* lib/memstat.h */
@@ -0,0 +1,22 @@
+#ifndef __LIB_POLL_H
+#define __LIB_POLL_H
+
+/* Descriptors and events for the poll system call.  Shared
+   between the kernel and user programs. */
+
+/* Events.  POLLERR, POLLHUP and POLLNVAL are always reported
+   and need not be requested. */
+#define POLLIN   0x001          /* Reading will not block. */
+#define POLLOUT  0x004          /* Writing will not block. */
+#define POLLERR  0x008          /* Pipe has no reader left. */
+#define POLLHUP  0x010          /* Pipe has no writer left. */
+#define POLLNVAL 0x020          /* Not an open descriptor. */
+
+/* One descriptor to poll. */
+struct pollfd {
+	int fd;                     /* Descriptor, or negative to skip. */
+	short events;               /* Requested events. */
+	short revents;              /* Returned events. */
+};
+
+#endif /* lib/poll.h */
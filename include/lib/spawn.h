@@ -0,0 +1,25 @@
+#ifndef __LIB_SPAWN_H
+#define __LIB_SPAWN_H
+
+/* File descriptor actions for the spawn system call.  Shared
+   between the kernel and user programs.  The child starts with
+   a copy of the caller's descriptors, then performs the actions
+   in order before it runs. */
+
+/* Maximum number of actions in one call. */
+#define SPAWN_ACTIONS_MAX 64
+
+/* Actions. */
+enum spawn_op {
+	SPAWN_CLOSE,                /* close(fd). */
+	SPAWN_DUP2                  /* dup2(fd, newfd). */
+};
+
+/* One action. */
+struct spawn_action {
+	int op;                     /* One of enum spawn_op. */
+	int fd;                     /* Descriptor to act on. */
+	int newfd;                  /* Target of SPAWN_DUP2. */
+};
+
+#endif /* lib/spawn.h */
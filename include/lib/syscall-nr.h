@@ -36,6 +36,32 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Statistics. */
+	SYS_MEMSTAT,                /* Report kernel and process memory usage. */
+	SYS_DMESG,                  /* Read the kernel log. */
+
+	/* Extended I/O. */
+	SYS_READV,                  /* Read into several buffers. */
+	SYS_WRITEV,                 /* Write from several buffers. */
+	SYS_PREAD,                  /* Read from a file at an offset. */
+	SYS_PWRITE,                 /* Write to a file at an offset. */
+	SYS_COPY_FILE_RANGE,        /* Copy data between files. */
+
+	/* Interprocess communication. */
+	SYS_PIPE,                   /* Create a pipe. */
+	SYS_POLL,                   /* Wait for descriptors to become ready. */
+
+	/* Batched I/O. */
+	SYS_URING_ENTER,            /* Run queued I/O operations. */
+
+	/* Process creation. */
+	SYS_SPAWN,                  /* Start a new process from a program file. */
+
+	/* Statistics, continued. */
+	SYS_SYSSTAT,                /* Report per-system-call statistics. */
+
+	SYS_CNT                     /* Number of system calls. */
 };
 
 #endif /* lib/syscall-nr.h */
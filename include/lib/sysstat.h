@@ -0,0 +1,30 @@
+#ifndef __LIB_SYSSTAT_H
+#define __LIB_SYSSTAT_H
+
+#include <stdint.h>
+
+/* Per-process statistics for one system call number, filled in by
+   the sysstat system call.  Shared between the kernel and user
+   programs.
+
+   Latencies are measured in time stamp counter cycles, from the
+   handler's dispatch to its return.  Calls that do not return,
+   such as exit and a successful exec, are counted but not
+   timed. */
+
+/* Number of latency histogram buckets. */
+#define SYSSTAT_BUCKETS 32
+
+struct sysstat {
+	uint64_t calls;             /* Invocations. */
+	uint64_t errors;            /* Returns of a negative value. */
+	uint64_t total_cycles;      /* Sum of latencies. */
+	uint64_t max_cycles;        /* Longest latency. */
+
+	/* hist[i] counts latencies of 2**i up to 2**(i+1) - 1 cycles.
+	   hist[0] also counts latencies of 0, and the last bucket
+	   counts everything above its lower bound. */
+	uint32_t hist[SYSSTAT_BUCKETS];
+};
+
+#endif /* lib/sysstat.h */
@@ -0,0 +1,18 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+#include <stddef.h>
+
+/* Buffer segments for the readv and writev system calls.
+   Shared between the kernel and user programs. */
+
+/* Maximum number of segments in one call. */
+#define IOV_MAX 1024
+
+/* One segment. */
+struct iovec {
+	void *iov_base;             /* Start of the segment. */
+	size_t iov_len;             /* Length in bytes. */
+};
+
+#endif /* lib/uio.h */
@@ -0,0 +1,63 @@
+#ifndef __LIB_URING_H
+#define __LIB_URING_H
+
+#include <stdint.h>
+
+/* Submission and completion rings for batching I/O system
+   calls.  Shared between the kernel and user programs.
+
+   A process keeps a struct uring in one page-aligned page of its
+   own memory.  It fills in submission queue entries (SQEs) at
+   sq_tail and advances sq_tail, then calls uring_enter().  The
+   kernel runs the queued operations in order, advancing sq_head
+   past each one, and posts a completion queue entry (CQE) with
+   the operation's result and the SQE's user_data at cq_tail.
+   The process consumes CQEs from cq_head.
+
+   Heads and tails run freely and are reduced modulo the ring
+   size on use.  Each index is written by one side only: the
+   process writes sq_tail and cq_head, the kernel sq_head and
+   cq_tail. */
+
+/* Ring sizes.  Both must be powers of two. */
+#define URING_SQ_ENTRIES 32
+#define URING_CQ_ENTRIES 64
+
+/* Operations. */
+enum uring_op {
+	URING_OP_NOP,               /* Do nothing; result is 0. */
+	URING_OP_READ,              /* read(fd, addr, len). */
+	URING_OP_WRITE,             /* write(fd, addr, len). */
+	URING_OP_PREAD,             /* pread(fd, addr, len, off). */
+	URING_OP_PWRITE,            /* pwrite(fd, addr, len, off). */
+	URING_OP_OPEN,              /* open(addr). */
+	URING_OP_CLOSE,             /* close(fd). */
+};
+
+/* Submission queue entry. */
+struct uring_sqe {
+	uint32_t op;                /* One of enum uring_op. */
+	int32_t fd;                 /* File descriptor. */
+	uint64_t addr;              /* Buffer or file name. */
+	uint32_t len;               /* Buffer length in bytes. */
+	int32_t off;                /* File offset for pread/pwrite. */
+	uint64_t user_data;         /* Copied into the completion. */
+};
+
+/* Completion queue entry. */
+struct uring_cqe {
+	uint64_t user_data;         /* From the submission. */
+	int64_t res;                /* Return value of the operation. */
+};
+
+/* The rings.  Must fit in, and be aligned to, one page. */
+struct uring {
+	volatile uint32_t sq_head;  /* Next SQE the kernel will take. */
+	volatile uint32_t sq_tail;  /* Next free SQE slot. */
+	volatile uint32_t cq_head;  /* Next CQE the process will take. */
+	volatile uint32_t cq_tail;  /* Next free CQE slot. */
+	struct uring_sqe sqes[URING_SQ_ENTRIES];
+	struct uring_cqe cqes[URING_CQ_ENTRIES];
+};
+
+#endif /* lib/uring.h */
@@ -1,7 +1,25 @@
 #ifndef __LIB_USER_STDIO_H
 #define __LIB_USER_STDIO_H
 
+/* Returned by stream functions on error. */
+#define EOF (-1)
+
+/* A buffered output stream. */
+typedef struct __stream FILE;
+
+/* Predefined streams. */
+extern FILE *stdout;
+extern FILE *stderr;
+
 int hprintf (int, const char *, ...) PRINTF_FORMAT (2, 3);
 int vhprintf (int, const char *, va_list) PRINTF_FORMAT (2, 0);
+int fprintf (FILE *, const char *, ...) PRINTF_FORMAT (2, 3);
+int vfprintf (FILE *, const char *, va_list) PRINTF_FORMAT (2, 0);
+int fputc (int, FILE *);
+int fputs (const char *, FILE *);
+int fflush (FILE *);
+
+/* Internal functions. */
+void __stdio_reset (void);
 
 #endif /* lib/user/stdio.h */
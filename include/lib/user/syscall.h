@@ -4,6 +4,12 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <memstat.h>
+#include <uio.h>
+#include <uring.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sysstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -50,6 +56,30 @@ bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
 
+/* Statistics. */
+bool memstat (struct memstat *ms);
+int dmesg (char *buffer, unsigned size);
+bool sysstat (int nr, struct sysstat *st);
+
+/* Extended I/O. */
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int pread (int fd, void *buffer, unsigned size, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned size, off_t offset);
+int copy_file_range (int fd_in, off_t *ofs_in, int fd_out, off_t *ofs_out,
+		unsigned size);
+
+/* Process creation. */
+pid_t spawn (const char *cmd_line, const struct spawn_action *actions,
+		int action_cnt);
+
+/* Interprocess communication. */
+int pipe (int fds[2]);
+int poll (struct pollfd *fds, unsigned nfds, int timeout);
+
+/* Batched I/O. */
+int uring_enter (struct uring *ring, unsigned to_submit);
+
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
 	asm volatile ("movq %0, %%rax" ::"r"(user_addr));
@@ -3,11 +3,14 @@
 
 #include <debug.h>
 #include <stddef.h>
+#include <memstat.h>
 
 void malloc_init (void);
 void *malloc (size_t) __attribute__ ((malloc));
 void *calloc (size_t, size_t) __attribute__ ((malloc));
 void *realloc (void *, size_t);
 void free (void *);
+void malloc_memstat (struct memstat *);
+void malloc_print_stats (void);
 
 #endif /* threads/malloc.h */
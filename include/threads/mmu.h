@@ -2,6 +2,7 @@
 #define THREAD_MMU_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "threads/pte.h"
 
@@ -11,9 +12,17 @@ uint64_t *pml4e_walk (uint64_t *pml4, const uint64_t va, int create);
 uint64_t *pml4_create (void);
 bool pml4_for_each (uint64_t *, pte_for_each_func *, void *);
 void pml4_destroy (uint64_t *pml4);
+void pml4_count_pages (uint64_t *pml4, size_t *rss, size_t *pt_pages);
 void pml4_activate (uint64_t *pml4);
 void *pml4_get_page (uint64_t *pml4, const void *upage);
+void *pml4_get_user_page (uint64_t *pml4, const void *upage, bool write);
 bool pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw);
+bool pml4_share_page (uint64_t *dst, void *upage, uint64_t *src,
+		uint64_t *src_pte);
+bool pml4_break_cow (uint64_t *pml4, const void *uaddr);
+bool pml4_set_large_page (uint64_t *pml4, void *va, void *kpage, bool rw);
+bool pml4_set_kernel_page (uint64_t *pml4, void *vpage, void *kpage);
+void *pml4_clear_kernel_page (uint64_t *pml4, void *vpage);
 void pml4_clear_page (uint64_t *pml4, void *upage);
 bool pml4_is_dirty (uint64_t *pml4, const void *upage);
 void pml4_set_dirty (uint64_t *pml4, const void *upage, bool dirty);
@@ -23,6 +32,7 @@ void pml4_set_accessed (uint64_t *pml4, const void *upage, bool accessed);
 #define is_writable(pte) (*(pte) & PTE_W)
 #define is_user_pte(pte) (*(pte) & PTE_U)
 #define is_kern_pte(pte) (!is_user_pte (pte))
+#define is_large_pte(pte) (*(pte) & PTE_PS)
 
 #define pte_get_paddr(pte) (pg_round_down(*(pte)))
 
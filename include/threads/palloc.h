@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <memstat.h>
 
 /* How to allocate pages. */
 enum palloc_flags {
@@ -14,10 +15,18 @@ enum palloc_flags {
 /* Maximum number of pages to put in user pool. */
 extern size_t user_page_limit;
 
+/* Frees pages that can be rebuilt later and returns how many. */
+typedef size_t palloc_reclaim_func (void);
+
 uint64_t palloc_init (void);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+void palloc_ref_page (void *);
+size_t palloc_page_refs (void *);
+void palloc_set_reclaim (palloc_reclaim_func *);
+void palloc_memstat (struct memstat *);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
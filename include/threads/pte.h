@@ -28,6 +28,12 @@
 #define PTX(la)  ((((uint64_t) (la)) >> PTXSHIFT) & 0x1FF)
 #define PTE_ADDR(pte) ((uint64_t) (pte) & ~0xFFF)
 
+/* A page directory entry with PTE_PS set maps a 2 MB "large" page
+   directly, without a page table below it. */
+#define LPGSIZE (1UL << PDXSHIFT)        /* Bytes in a large page. */
+#define LPGMASK (LPGSIZE - 1)            /* Large page offset bits (0:21). */
+#define LPTE_ADDR(pde) ((uint64_t) (pde) & ~LPGMASK)
+
 /* The important flags are listed below.
    When a PDE or PTE is not "present", the other flags are
    ignored.
@@ -41,5 +47,7 @@
 #define PTE_U 0x4                        /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20                       /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40                       /* 1=dirty, 0=not dirty (PTEs only). */
+#define PTE_PS 0x80                      /* 1=large page, 0=page table (PDEs only). */
+#define PTE_COW 0x200                    /* 1=shared copy-on-write (in PTE_AVL). */
 
 #endif /* threads/pte.h */
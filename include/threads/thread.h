@@ -12,12 +12,24 @@
 #endif
 
 // P2
-// file_list에 포함되는 구조체, file 구조체와 file descriptor를 포함
+// fd_table의 fd가 가리키는 구조체, dup2로 복사된 fd들은 하나의 file_elem을 공유
 struct file_elem {
-	int fd;
 	struct file *file;
 	int std_no; // stdin, stdout일 경우 0, 1, 일반 파일은 -1
-	struct list_elem elem;
+	struct pipe *pipe; // 파이프의 한쪽 끝이면 그 파이프, 아니면 NULL
+	bool writer; // 파이프의 쓰는 쪽이면 true
+	int ref_cnt; // 이 file_elem을 가리키는 fd의 수
+	struct file_elem *clone; // fork 중 자식 쪽 복사본
+};
+
+#define FD_TABLE_MIN 64 // fd_table의 초기 칸 수 (64의 배수)
+#define FD_MAX 4096 // 허용하는 최대 fd + 1
+
+// fd로 바로 찾는 file_elem 배열과 가장 작은 빈 fd를 찾기 위한 비트맵
+struct fd_table {
+	struct file_elem **fes; // fd번째 칸에 file_elem, 빈 fd는 NULL
+	uint64_t *used; // fd번째 비트가 1이면 사용 중
+	int size; // 배열의 칸 수
 };
 
 /* States in a thread's life cycle. */
@@ -124,12 +136,13 @@ struct thread {
 	uint64_t *pml4;                     /* Page map level 4 */
 	// P2
 	struct file *exe_file; // 실행중인 프로그램의 파일 구조체
-	struct list file_list; // 열려있는 파일의 리스트, fd순으로 정렬되어있음
+	struct fd_table fd_table; // fd로 찾는 열린 파일 table
 	tid_t p_tid; // 부모 쓰레드의 tid
 	struct semaphore wait_sema; // 부모가 현재 쓰레드 종료를 대기
 	struct semaphore reap_sema; // 현재 쓰레드가 부모의 wait 호출을 대기
 	int exit_status;
 	bool is_user;
+	struct sysstat *sysstats; // 시스템 콜 번호별 통계 (SYS_CNT개), 첫 시스템 콜에서 할당
 #endif
 #ifdef VM
 	/* Table for whole virtual memory owned by thread. */
@@ -163,6 +176,11 @@ void thread_unblock (struct thread *);
 void thread_sleep_until(int64_t wake_tick);
 int64_t thread_wake_sleepers(int64_t cur_tick);
 
+// P2
+uint64_t thread_poll_seq(void);
+void thread_poll_wait(uint64_t seq, int64_t wake_tick);
+void thread_poll_wake(void);
+
 struct thread *thread_current (void);
 tid_t thread_tid (void);
 const char *thread_name (void);
@@ -187,8 +205,14 @@ bool thread_priority_less(const struct list_elem *a,
 	const struct list_elem *b, void *aux); // P1-AS
 
 // P2
-bool syscall_dup_file_list(void *old_t, void *new_t);
-void syscall_clear_file_list(void);
+struct file_elem *thread_get_fe(int fd);
+int thread_add_fe(struct file_elem *fe);
+bool thread_set_fe(int fd, struct file_elem *fe);
+bool thread_dup_fe(int oldfd, int newfd);
+struct file_elem *thread_remove_fe(int fd);
+void thread_put_fe(struct file_elem *fe);
+bool thread_dup_fd_table(struct thread *old_t, struct thread *new_t);
+void thread_clear_fd_table(struct thread *t);
 struct thread *thread_get_by_id(tid_t tid);
 int thread_wait(tid_t child_tid);
 
@@ -0,0 +1,25 @@
+#ifndef THREADS_VMALLOC_H
+#define THREADS_VMALLOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/vaddr.h"
+
+/* Kernel virtual range backing vmalloc().  It lies under the same
+   page-map-level-4 entry as the kernel's direct map, so every
+   address space created by pml4_create() shares its page tables. */
+#define VMALLOC_START 0xc000000000UL
+#define VMALLOC_SIZE  (256UL << 20)
+#define VMALLOC_END   (VMALLOC_START + VMALLOC_SIZE)
+
+/* Returns true if VADDR was returned by vmalloc(). */
+#define is_vmalloc_vaddr(vaddr) \
+	((uint64_t) (vaddr) >= VMALLOC_START && (uint64_t) (vaddr) < VMALLOC_END)
+
+void vmalloc_init (void);
+void *vmalloc (size_t) __attribute__ ((malloc));
+void *vcalloc (size_t, size_t) __attribute__ ((malloc));
+void vfree (void *);
+
+#endif /* threads/vmalloc.h */
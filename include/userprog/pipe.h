@@ -0,0 +1,22 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Anonymous pipes.  A pipe is a ring buffer in kernel memory
+   with a read end and a write end, each of which may be held by
+   any number of file descriptors across processes.  Readers
+   block while the pipe is empty and writers while it is full.
+   Every change in readiness wakes threads blocked in poll. */
+
+struct pipe;
+
+struct pipe *pipe_create (void);
+void pipe_open (struct pipe *, bool writer);
+void pipe_close (struct pipe *, bool writer);
+size_t pipe_read (struct pipe *, void *, size_t size, bool wait);
+int pipe_write (struct pipe *, const void *, size_t size);
+int pipe_poll (struct pipe *, bool writer);
+
+#endif /* userprog/pipe.h */
@@ -3,8 +3,13 @@
 
 #include "threads/thread.h"
 
+struct spawn_action;
+
+void process_cache_init (void);
 tid_t process_create_initd (const char *file_name);
 tid_t process_fork (const char *name, struct intr_frame *if_);
+tid_t process_spawn (char *cmd_line, const struct spawn_action *actions,
+		int action_cnt);
 int process_exec (void *f_name);
 int process_wait (tid_t);
 void process_exit (void);
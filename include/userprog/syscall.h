@@ -1,7 +1,14 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stdbool.h>
+
+/* -sc: Print each process's system call statistics when it
+   exits? */
+extern bool syscall_print_stats;
+
 void syscall_init (void);
+void syscall_release_stats (void);
 
 void syscall_terminate(void); // P2
 void print_if(void *if_, char *desc); //////////// DEBUG
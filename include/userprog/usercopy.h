@@ -0,0 +1,17 @@
+#ifndef USERPROG_USERCOPY_H
+#define USERPROG_USERCOPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Copying between kernel and user memory.  These touch user
+   memory directly, without looking the pages up first, and
+   fail cleanly if any part of the user range is unmapped or
+   lies in kernel space. */
+
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int64_t strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+#endif /* userprog/usercopy.h */
@@ -1,20 +1,59 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 
 static void vprintf_helper (char, void *);
 static void putchar_have_lock (uint8_t c);
+static void ring_get (uint64_t pos, void *, size_t);
+static void write_record (void);
+static void drain_log (void);
+static void log_write (const char *, size_t);
+static void drain_thread (void *aux);
+
+/* The kernel log.
+
+   Console output does not go straight to the vga display and
+   serial port, which would stall every caller for the time it
+   takes the serial port to send each character.  Instead, each
+   write is appended to this ring as a record of up to
+   LOG_MSG_MAX bytes, preceded by a length byte, and the "klog"
+   thread later copies the records out to the devices.  Appending
+   only disables interrupts for the length of a short memcpy(),
+   so it is safe from any context and never sleeps.
+
+   Three positions, which only ever increase, divide the ring:
+   records from `log_tail' to `log_drain' have been output but
+   are kept for console_read_log(); records from `log_drain' to
+   `log_head' are waiting to be output.  All three are protected
+   by disabling interrupts. */
+#define LOG_SIZE CONSOLE_LOG_SIZE        /* Bytes in the ring. */
+#define LOG_MSG_MAX 128                 /* Largest record. */
+static uint8_t log_buf[LOG_SIZE];
+static uint64_t log_head;               /* Where the next record goes. */
+static uint64_t log_drain;              /* Oldest record not yet output. */
+static uint64_t log_tail;               /* Oldest record kept. */
+static int64_t lost_cnt;                /* Records dropped unprinted. */
+
+/* The thread that drains the log, and whether it is blocked
+   waiting for more records.  Until the thread starts, and after
+   a kernel panics, output is written out synchronously. */
+static struct thread *drain;
+static bool drain_blocked;
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
    safe to call them at any time.
    But this lock is useful to prevent simultaneous printf() calls
-   from mixing their output, which looks confusing. */
+   from mixing their output, which looks confusing.  Now that
+   output goes through the kernel log, it is held by whichever
+   thread is copying records out to the devices. */
 static struct lock console_lock;
 
 /* True in ordinary circumstances: we want to use the console
@@ -35,7 +74,7 @@ static bool use_console_lock;
    a real example, I added a printf() call to palloc_free().
    Here's a real backtrace that resulted:
 
-   lock_console()
+   lock_acquire()
    vprintf()
    printf()             - palloc() tries to grab the lock again
    palloc_free()        
@@ -51,10 +90,11 @@ static bool use_console_lock;
    syscall_handler()
    intr_handler()
 
-   This kind of thing is very difficult to debug, so we avoid the
-   problem by simulating a recursive lock with a depth
-   counter. */
-static int console_lock_depth;
+   This kind of thing is very difficult to debug.  Writers no
+   longer take the lock just to log, but a thread that holds it
+   to drain the log can still end up in printf() this way, so the
+   paths that might take the lock check whether the current
+   thread already holds it. */
 
 /* Number of characters written to console. */
 static int64_t write_cnt;
@@ -66,74 +106,121 @@ console_init (void) {
 	use_console_lock = true;
 }
 
+/* Starts the thread that drains the kernel log.  Until then,
+   output is written out as soon as it is logged. */
+void
+console_start_drain (void) {
+	tid_t tid = thread_create ("klog", PRI_MIN, drain_thread, NULL);
+	ASSERT (tid != TID_ERROR);
+}
+
 /* Notifies the console that a kernel panic is underway,
    which warns it to avoid trying to take the console lock from
-   now on. */
+   now on.  Output from here on is written out synchronously,
+   after anything still waiting in the log. */
 void
 console_panic (void) {
 	use_console_lock = false;
+	console_flush ();
 }
 
-/* Prints console statistics. */
+/* Writes out everything waiting in the kernel log, then waits
+   for the serial port to send it. */
 void
-console_print_stats (void) {
-	printf ("Console: %lld characters output\n", write_cnt);
-}
+console_flush (void) {
+	enum intr_level old_level;
 
-/* Acquires the console lock. */
-	static void
-acquire_console (void) {
-	if (!intr_context () && use_console_lock) {
-		if (lock_held_by_current_thread (&console_lock)) 
-			console_lock_depth++; 
-		else
-			lock_acquire (&console_lock); 
+	if (use_console_lock && !intr_context ()
+			&& intr_get_level () == INTR_ON
+			&& !lock_held_by_current_thread (&console_lock)) {
+		lock_acquire (&console_lock);
+		drain_log ();
+		lock_release (&console_lock);
 	}
+
+	old_level = intr_disable ();
+	while (log_drain != log_head)
+		write_record ();
+	intr_set_level (old_level);
+	serial_flush ();
 }
 
-/* Releases the console lock. */
-static void
-release_console (void) {
-	if (!intr_context () && use_console_lock) {
-		if (console_lock_depth > 0)
-			console_lock_depth--;
-		else
-			lock_release (&console_lock); 
+/* Copies up to SIZE bytes of the text in the kernel log into
+   BUF, which must be in kernel memory, and returns the number of
+   bytes copied.  If the log holds more than SIZE bytes, the
+   oldest whole records are left out. */
+size_t
+console_read_log (char *buf, size_t size) {
+	enum intr_level old_level = intr_disable ();
+	size_t len = 0, copied = 0;
+	uint64_t pos;
+
+	for (pos = log_tail; pos != log_head; pos += 1 + log_buf[pos % LOG_SIZE])
+		len += log_buf[pos % LOG_SIZE];
+
+	/* Skip old records until the rest fits. */
+	for (pos = log_tail; len > size; pos += 1 + log_buf[pos % LOG_SIZE])
+		len -= log_buf[pos % LOG_SIZE];
+
+	for (; pos != log_head; pos += 1 + log_buf[pos % LOG_SIZE]) {
+		size_t rec_len = log_buf[pos % LOG_SIZE];
+		ring_get (pos + 1, buf + copied, rec_len);
+		copied += rec_len;
 	}
+	intr_set_level (old_level);
+
+	return copied;
+}
+
+/* Prints console statistics. */
+void
+console_print_stats (void) {
+	printf ("Console: %lld characters output\n", write_cnt);
+	if (lost_cnt > 0)
+		printf ("Console: %lld log records lost\n", lost_cnt);
 }
 
-/* Returns true if the current thread has the console lock,
-   false otherwise. */
+/* Returns true if the current thread may write to the devices:
+   it has the console lock, or nothing can preempt it. */
 static bool
 console_locked_by_current_thread (void) {
 	return (intr_context ()
+			|| intr_get_level () == INTR_OFF
 			|| !use_console_lock
 			|| lock_held_by_current_thread (&console_lock));
 }
 
+/* Buffer that vprintf() formats into, flushed to the log a
+   record at a time. */
+struct vprintf_buf {
+	char text[LOG_MSG_MAX];     /* Text not yet logged. */
+	size_t len;                 /* Bytes in `text'. */
+	int char_cnt;               /* Characters formatted so far. */
+};
+
 /* The standard vprintf() function,
    which is like printf() but uses a va_list.
-   Writes its output to both vga display and serial port. */
+   Writes its output to both vga display and serial port, by way
+   of the kernel log. */
 int
 vprintf (const char *format, va_list args) {
-	int char_cnt = 0;
+	struct vprintf_buf aux;
 
-	acquire_console ();
-	__vprintf (format, args, vprintf_helper, &char_cnt);
-	release_console ();
+	aux.len = 0;
+	aux.char_cnt = 0;
+	__vprintf (format, args, vprintf_helper, &aux);
+	if (aux.len > 0)
+		log_write (aux.text, aux.len);
 
-	return char_cnt;
+	return aux.char_cnt;
 }
 
 /* Writes string S to the console, followed by a new-line
    character. */
 int
 puts (const char *s) {
-	acquire_console ();
-	while (*s != '\0')
-		putchar_have_lock (*s++);
-	putchar_have_lock ('\n');
-	release_console ();
+	putbuf (s, strlen (s));
+	putchar ('\n');
 
 	return 0;
 }
@@ -141,28 +228,40 @@ puts (const char *s) {
 /* Writes the N characters in BUFFER to the console. */
 void
 putbuf (const char *buffer, size_t n) {
-	acquire_console ();
-	while (n-- > 0)
-		putchar_have_lock (*buffer++);
-	release_console ();
+	/* BUFFER may be in user memory, which must not be touched
+	   with interrupts off, so copy it out first. */
+	while (n > 0) {
+		char text[LOG_MSG_MAX];
+		size_t len = n < LOG_MSG_MAX ? n : LOG_MSG_MAX;
+
+		memcpy (text, buffer, len);
+		log_write (text, len);
+		buffer += len;
+		n -= len;
+	}
 }
 
 /* Writes C to the vga display and serial port. */
 int
 putchar (int c) {
-	acquire_console ();
-	putchar_have_lock (c);
-	release_console ();
+	char text = c;
+
+	log_write (&text, 1);
 
 	return c;
 }
-
+
 /* Helper function for vprintf(). */
 static void
-vprintf_helper (char c, void *char_cnt_) {
-	int *char_cnt = char_cnt_;
-	(*char_cnt)++;
-	putchar_have_lock (c);
+vprintf_helper (char c, void *aux_) {
+	struct vprintf_buf *aux = aux_;
+
+	aux->char_cnt++;
+	aux->text[aux->len++] = c;
+	if (aux->len == LOG_MSG_MAX) {
+		log_write (aux->text, aux->len);
+		aux->len = 0;
+	}
 }
 
 /* Writes C to the vga display and serial port.
@@ -175,3 +274,173 @@ putchar_have_lock (uint8_t c) {
 	serial_putc (c);
 	vga_putc (c);
 }
+
+/* Copies the N bytes at SRC into the ring at position POS. */
+static void
+ring_put (uint64_t pos, const void *src_, size_t n) {
+	const uint8_t *src = src_;
+	size_t ofs = pos % LOG_SIZE;
+	size_t first = n < LOG_SIZE - ofs ? n : LOG_SIZE - ofs;
+
+	memcpy (log_buf + ofs, src, first);
+	memcpy (log_buf, src + first, n - first);
+}
+
+/* Copies N bytes from the ring at position POS into DST. */
+static void
+ring_get (uint64_t pos, void *dst_, size_t n) {
+	uint8_t *dst = dst_;
+	size_t ofs = pos % LOG_SIZE;
+	size_t first = n < LOG_SIZE - ofs ? n : LOG_SIZE - ofs;
+
+	memcpy (dst, log_buf + ofs, first);
+	memcpy (dst + first, log_buf, n - first);
+}
+
+/* Appends the LEN bytes of TEXT to the log as one record,
+   discarding records that have already been output to make
+   room.  Returns false if that is not enough.  Interrupts must
+   be off. */
+static bool
+log_append (const char *text, size_t len) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (len <= LOG_MSG_MAX);
+
+	while (LOG_SIZE - (log_head - log_tail) < 1 + len) {
+		if (log_tail == log_drain)
+			return false;
+		log_tail += 1 + log_buf[log_tail % LOG_SIZE];
+	}
+
+	log_buf[log_head % LOG_SIZE] = len;
+	ring_put (log_head + 1, text, len);
+	log_head += 1 + len;
+	return true;
+}
+
+/* Writes the oldest record not yet output to the devices.
+   Interrupts must be off. */
+static void
+write_record (void) {
+	size_t len = log_buf[log_drain % LOG_SIZE];
+	uint64_t pos;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (pos = log_drain + 1; pos < log_drain + 1 + len; pos++)
+		putchar_have_lock (log_buf[pos % LOG_SIZE]);
+	log_drain += 1 + len;
+}
+
+/* Writes every record not yet output to the devices, a record
+   at a time with interrupts on.  The caller must hold the
+   console lock. */
+static void
+drain_log (void) {
+	static char text[LOG_MSG_MAX];
+
+	ASSERT (lock_held_by_current_thread (&console_lock));
+
+	for (;;) {
+		enum intr_level old_level = intr_disable ();
+		size_t len, i;
+
+		if (log_drain == log_head) {
+			intr_set_level (old_level);
+			break;
+		}
+		len = log_buf[log_drain % LOG_SIZE];
+		ring_get (log_drain + 1, text, len);
+		log_drain += 1 + len;
+		intr_set_level (old_level);
+
+		write_cnt += len;
+		serial_putbuf ((const uint8_t *) text, len);
+		for (i = 0; i < len; i++)
+			vga_putc (text[i]);
+	}
+}
+
+/* Makes room in the full log by getting its oldest record out
+   of the way. */
+static void
+make_room (void) {
+	enum intr_level old_level;
+
+	if (!intr_context () && intr_get_level () == INTR_ON
+			&& !lock_held_by_current_thread (&console_lock)) {
+		/* Drain the log ourselves, waiting for (and donating
+		   priority to) the klog thread if it is in the middle of
+		   a record. */
+		lock_acquire (&console_lock);
+		drain_log ();
+		lock_release (&console_lock);
+		return;
+	}
+
+	/* We cannot sleep.  Write the record out directly, unless a
+	   thread is part way through writing an earlier one, in
+	   which case the record has to go. */
+	old_level = intr_disable ();
+	if (log_drain != log_head) {
+		if (console_lock.holder == NULL)
+			write_record ();
+		else {
+			log_drain += 1 + log_buf[log_drain % LOG_SIZE];
+			lost_cnt++;
+		}
+	}
+	intr_set_level (old_level);
+}
+
+/* Logs the LEN bytes of TEXT, which must be in kernel memory,
+   and arranges for them to be output. */
+static void
+log_write (const char *text, size_t len) {
+	enum intr_level old_level;
+
+	for (;;) {
+		old_level = intr_disable ();
+		if (log_append (text, len))
+			break;
+		intr_set_level (old_level);
+		make_room ();
+	}
+
+	if (drain == NULL || !use_console_lock) {
+		/* No klog thread yet, or a panic: write out now. */
+		while (log_drain != log_head)
+			write_record ();
+	} else if (drain_blocked) {
+		drain_blocked = false;
+		thread_unblock (drain);
+	}
+	intr_set_level (old_level);
+}
+
+/* The klog thread.  Writes out the log whenever it is not
+   empty, at the lowest priority so that logging never holds up
+   real work. */
+static void
+drain_thread (void *aux UNUSED) {
+	enum intr_level old_level;
+
+	thread_set_nice (NICE_MAX);
+
+	old_level = intr_disable ();
+	drain = thread_current ();
+	intr_set_level (old_level);
+
+	for (;;) {
+		old_level = intr_disable ();
+		if (log_drain == log_head) {
+			drain_blocked = true;
+			thread_block ();
+		}
+		intr_set_level (old_level);
+
+		lock_acquire (&console_lock);
+		drain_log ();
+		lock_release (&console_lock);
+	}
+}
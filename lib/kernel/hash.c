@@ -8,6 +8,7 @@
 #include "hash.h"
 #include "../debug.h"
 #include "threads/malloc.h"
+#include "threads/vmalloc.h"
 
 #define list_elem_to_hash_elem(LIST_ELEM)                       \
 	list_entry(LIST_ELEM, struct hash_elem, list_elem)
@@ -18,6 +19,8 @@ static struct hash_elem *find_elem (struct hash *, struct list *,
 static void insert_elem (struct hash *, struct list *, struct hash_elem *);
 static void remove_elem (struct hash *, struct hash_elem *);
 static void rehash (struct hash *);
+static struct list *alloc_buckets (size_t bucket_cnt);
+static void free_buckets (struct list *);
 
 /* Initializes hash table H to compute hash values using HASH and
    compare hash elements using LESS, given auxiliary data AUX. */
@@ -26,7 +29,7 @@ hash_init (struct hash *h,
 		hash_hash_func *hash, hash_less_func *less, void *aux) {
 	h->elem_cnt = 0;
 	h->bucket_cnt = 4;
-	h->buckets = malloc (sizeof *h->buckets * h->bucket_cnt);
+	h->buckets = alloc_buckets (h->bucket_cnt);
 	h->hash = hash;
 	h->less = less;
 	h->aux = aux;
@@ -81,7 +84,7 @@ void
 hash_destroy (struct hash *h, hash_action_func *destructor) {
 	if (destructor != NULL)
 		hash_clear (h, destructor);
-	free (h->buckets);
+	free_buckets (h->buckets);
 }
 
 /* Inserts NEW into hash table H and returns a null pointer, if
@@ -345,7 +348,7 @@ rehash (struct hash *h) {
 		return;
 
 	/* Allocate new buckets and initialize them as empty. */
-	new_buckets = malloc (sizeof *new_buckets * new_bucket_cnt);
+	new_buckets = alloc_buckets (new_bucket_cnt);
 	if (new_buckets == NULL) {
 		/* Allocation failed.  This means that use of the hash table will
 		   be less efficient.  However, it is still usable, so
@@ -375,7 +378,26 @@ rehash (struct hash *h) {
 		}
 	}
 
-	free (old_buckets);
+	free_buckets (old_buckets);
+}
+
+/* Allocates an array of BUCKET_CNT buckets.  Arrays too big for a
+   malloc() descriptor would need physically contiguous pages, so
+   they come from vmalloc() instead. */
+static struct list *
+alloc_buckets (size_t bucket_cnt) {
+	size_t size = sizeof (struct list) * bucket_cnt;
+
+	return size > PGSIZE / 2 ? vmalloc (size) : malloc (size);
+}
+
+/* Frees BUCKETS, allocated by alloc_buckets(). */
+static void
+free_buckets (struct list *buckets) {
+	if (is_vmalloc_vaddr (buckets))
+		vfree (buckets);
+	else
+		free (buckets);
 }
 
 /* Inserts E into BUCKET (in hash table H). */
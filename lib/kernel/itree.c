@@ -0,0 +1,146 @@
+/* Interval tree.
+
+   See itree.h for basic information.  The overlap search is the
+   augmented-tree search of Cormen, Leiserson, Rivest and Stein,
+   "Introduction to Algorithms", section 14.3, extended to find
+   the leftmost overlapping range and continue in order from
+   there. */
+
+#include "itree.h"
+#include "../debug.h"
+
+#define rb_to_itree(RB_NODE) rb_entry (RB_NODE, struct itree_node, rb_node)
+
+static bool start_less (const struct rb_node *, const struct rb_node *,
+		void *);
+static void update_max_end (struct rb_node *, void *);
+static struct itree_node *subtree_first (struct itree_node *,
+		uint64_t start, uint64_t end);
+
+/* Initializes T as an empty interval tree. */
+void
+itree_init (struct itree *t) {
+	rb_init_augmented (&t->rb_tree, start_less, update_max_end, NULL);
+}
+
+/* Inserts N into T as the range [START, END). */
+void
+itree_insert (struct itree *t, struct itree_node *n,
+		uint64_t start, uint64_t end) {
+	ASSERT (start < end);
+
+	n->start = start;
+	n->end = end;
+	n->max_end = end;
+	rb_insert (&t->rb_tree, &n->rb_node);
+}
+
+/* Removes N, which must be in T, from T. */
+void
+itree_remove (struct itree *t, struct itree_node *n) {
+	rb_remove (&t->rb_tree, &n->rb_node);
+}
+
+/* Returns the range in T with the lowest start that overlaps
+   [START, END), or a null pointer if there is none. */
+struct itree_node *
+itree_first (struct itree *t, uint64_t start, uint64_t end) {
+	struct itree_node *root;
+
+	if (t->rb_tree.root == NULL)
+		return NULL;
+	root = rb_to_itree (t->rb_tree.root);
+	return root->max_end > start ? subtree_first (root, start, end) : NULL;
+}
+
+/* Returns the next range after N, in order of start, that
+   overlaps [START, END), or a null pointer if there is none.
+   START and END must be the ones passed to itree_first(). */
+struct itree_node *
+itree_next (struct itree_node *n, uint64_t start, uint64_t end) {
+	struct rb_node *rb = n->rb_node.right;
+
+	for (;;) {
+		struct rb_node *prev;
+
+		/* RB is the right child of N, or null.  Everything below
+		   it comes after N. */
+		if (rb != NULL && rb_to_itree (rb)->max_end > start)
+			return subtree_first (rb_to_itree (rb), start, end);
+
+		/* Climb until we come up from a left child; that parent
+		   is the next node in order. */
+		do {
+			prev = &n->rb_node;
+			if (prev->parent == NULL)
+				return NULL;
+			n = rb_to_itree (prev->parent);
+			rb = n->rb_node.right;
+		} while (prev == rb);
+
+		if (n->start >= end)
+			return NULL;
+		if (n->end > start)
+			return n;
+	}
+}
+
+/* Returns the number of ranges in T. */
+size_t
+itree_size (struct itree *t) {
+	return rb_size (&t->rb_tree);
+}
+
+/* Returns true if T is empty, false otherwise. */
+bool
+itree_empty (struct itree *t) {
+	return rb_empty (&t->rb_tree);
+}
+
+/* Orders interval tree nodes A and B by start. */
+static bool
+start_less (const struct rb_node *a, const struct rb_node *b,
+		void *aux UNUSED) {
+	return rb_to_itree (a)->start < rb_to_itree (b)->start;
+}
+
+/* Recomputes the greatest end below interval tree node N. */
+static void
+update_max_end (struct rb_node *n, void *aux UNUSED) {
+	struct itree_node *in = rb_to_itree (n);
+	uint64_t max_end = in->end;
+
+	if (n->left != NULL && rb_to_itree (n->left)->max_end > max_end)
+		max_end = rb_to_itree (n->left)->max_end;
+	if (n->right != NULL && rb_to_itree (n->right)->max_end > max_end)
+		max_end = rb_to_itree (n->right)->max_end;
+	in->max_end = max_end;
+}
+
+/* Returns the range below and including N with the lowest start
+   that overlaps [START, END), or a null pointer if there is none.
+   N's subtree must contain a range that ends after START. */
+static struct itree_node *
+subtree_first (struct itree_node *n, uint64_t start, uint64_t end) {
+	for (;;) {
+		struct rb_node *left = n->rb_node.left;
+		struct rb_node *right = n->rb_node.right;
+
+		/* If some range on the left ends after START, either it
+		   overlaps or it starts at or after END, and then so does
+		   everything from N on. */
+		if (left != NULL && rb_to_itree (left)->max_end > start) {
+			n = rb_to_itree (left);
+			continue;
+		}
+		if (n->start >= end)
+			return NULL;
+		if (n->end > start)
+			return n;
+		if (right != NULL && rb_to_itree (right)->max_end > start) {
+			n = rb_to_itree (right);
+			continue;
+		}
+		return NULL;
+	}
+}
@@ -0,0 +1,454 @@
+/* Radix tree.
+
+   See radix.h for basic information. */
+
+#include "radix.h"
+#include "../debug.h"
+#include "threads/malloc.h"
+
+#define RADIX_MASK (RADIX_SLOTS - 1)
+
+/* A node.  Nodes with SHIFT 0 are leaves, whose slots hold the
+   entries themselves; the slots of other nodes point to the
+   children that cover each 1/RADIX_SLOTS of their range. */
+struct radix_node {
+	uint8_t shift;              /* Index bits below this level. */
+	uint8_t offset;             /* Slot in `parent'. */
+	uint16_t count;             /* Number of non-null slots. */
+	struct radix_node *parent;  /* Parent node, or null for the root. */
+	uint64_t tags[RADIX_TAG_CNT]; /* Per slot: tagged entry at or below? */
+	void *slots[RADIX_SLOTS];   /* Children or entries. */
+};
+
+static struct radix_node *node_alloc (unsigned shift,
+		struct radix_node *parent, unsigned offset);
+static void node_free_all (struct radix_node *, radix_action_func *,
+		uint64_t base);
+static struct radix_node *find_leaf (struct radix_tree *, uint64_t index);
+static void prune (struct radix_tree *, struct radix_node *);
+static bool clear_tag (struct radix_node *, unsigned offset, unsigned tag);
+static void *find_next (struct radix_tree *, uint64_t *index,
+		uint64_t last, int tag);
+
+/* Returns the greatest index that fits below NODE. */
+static inline uint64_t
+max_index (const struct radix_node *node) {
+	return node->shift + RADIX_SHIFT >= 64
+		? UINT64_MAX : ((uint64_t) RADIX_SLOTS << node->shift) - 1;
+}
+
+/* Returns the slot of NODE that covers INDEX. */
+static inline unsigned
+slot_of (const struct radix_node *node, uint64_t index) {
+	return (index >> node->shift) & RADIX_MASK;
+}
+
+/* Initializes T as an empty tree. */
+void
+radix_init (struct radix_tree *t) {
+	t->root = NULL;
+	t->cnt = 0;
+}
+
+/* Frees all of T's nodes, leaving T empty.
+
+   If DESTRUCTOR is non-null, then it is first called for each
+   entry, in index order. */
+void
+radix_destroy (struct radix_tree *t, radix_action_func *destructor) {
+	if (t->root != NULL)
+		node_free_all (t->root, destructor, 0);
+	t->root = NULL;
+	t->cnt = 0;
+}
+
+/* Stores ITEM, which must not be null, at INDEX in T.  Returns
+   true if successful, false if INDEX is already in use or memory
+   is exhausted. */
+bool
+radix_insert (struct radix_tree *t, uint64_t index, void *item) {
+	struct radix_node *node;
+	unsigned i, tag;
+
+	ASSERT (item != NULL);
+
+	if (t->root == NULL) {
+		unsigned shift = 0;
+
+		while (index > ((uint64_t) RADIX_SLOTS << shift) - 1
+				&& shift + RADIX_SHIFT < 64)
+			shift += RADIX_SHIFT;
+		t->root = node_alloc (shift, NULL, 0);
+		if (t->root == NULL)
+			return false;
+	}
+
+	/* Grow the tree upward until its root covers INDEX. */
+	while (index > max_index (t->root)) {
+		struct radix_node *root = t->root;
+		struct radix_node *new = node_alloc (root->shift + RADIX_SHIFT,
+				NULL, 0);
+		if (new == NULL)
+			return false;
+
+		new->slots[0] = root;
+		new->count = 1;
+		for (tag = 0; tag < RADIX_TAG_CNT; tag++)
+			if (root->tags[tag] != 0)
+				new->tags[tag] = 1;
+		root->parent = new;
+		root->offset = 0;
+		t->root = new;
+	}
+
+	/* Walk down, adding nodes as needed. */
+	node = t->root;
+	while (node->shift > 0) {
+		i = slot_of (node, index);
+		if (node->slots[i] == NULL) {
+			struct radix_node *child = node_alloc (node->shift - RADIX_SHIFT,
+					node, i);
+			if (child == NULL) {
+				prune (t, node);
+				return false;
+			}
+			node->slots[i] = child;
+			node->count++;
+		}
+		node = node->slots[i];
+	}
+
+	i = slot_of (node, index);
+	if (node->slots[i] != NULL)
+		return false;
+	node->slots[i] = item;
+	node->count++;
+	t->cnt++;
+	return true;
+}
+
+/* Returns the entry at INDEX in T, or a null pointer if there is
+   none. */
+void *
+radix_lookup (struct radix_tree *t, uint64_t index) {
+	struct radix_node *leaf = find_leaf (t, index);
+
+	return leaf != NULL ? leaf->slots[slot_of (leaf, index)] : NULL;
+}
+
+/* Removes and returns the entry at INDEX in T, along with its
+   tags.  Returns a null pointer if there was no entry there. */
+void *
+radix_delete (struct radix_tree *t, uint64_t index) {
+	struct radix_node *leaf = find_leaf (t, index);
+	unsigned i, tag;
+	void *item;
+
+	if (leaf == NULL)
+		return NULL;
+	i = slot_of (leaf, index);
+	item = leaf->slots[i];
+	if (item == NULL)
+		return NULL;
+
+	for (tag = 0; tag < RADIX_TAG_CNT; tag++)
+		clear_tag (leaf, i, tag);
+	leaf->slots[i] = NULL;
+	leaf->count--;
+	t->cnt--;
+	prune (t, leaf);
+	return item;
+}
+
+/* Sets TAG on the entry at INDEX in T, which must exist. */
+void
+radix_tag_set (struct radix_tree *t, uint64_t index, enum radix_tag tag) {
+	struct radix_node *node = t->root;
+
+	ASSERT (tag < RADIX_TAG_CNT);
+	ASSERT (radix_lookup (t, index) != NULL);
+
+	for (;;) {
+		unsigned i = slot_of (node, index);
+
+		node->tags[tag] |= 1ULL << i;
+		if (node->shift == 0)
+			break;
+		node = node->slots[i];
+	}
+}
+
+/* Clears TAG on the entry at INDEX in T, if there is one. */
+void
+radix_tag_clear (struct radix_tree *t, uint64_t index, enum radix_tag tag) {
+	struct radix_node *leaf = find_leaf (t, index);
+
+	ASSERT (tag < RADIX_TAG_CNT);
+
+	if (leaf != NULL)
+		clear_tag (leaf, slot_of (leaf, index), tag);
+}
+
+/* Returns true if there is an entry at INDEX in T with TAG set,
+   false otherwise. */
+bool
+radix_tag_get (struct radix_tree *t, uint64_t index, enum radix_tag tag) {
+	struct radix_node *leaf = find_leaf (t, index);
+
+	ASSERT (tag < RADIX_TAG_CNT);
+
+	return leaf != NULL && (leaf->tags[tag] >> slot_of (leaf, index)) & 1;
+}
+
+/* Returns true if any entry in T has TAG set, false
+   otherwise. */
+bool
+radix_tagged (struct radix_tree *t, enum radix_tag tag) {
+	ASSERT (tag < RADIX_TAG_CNT);
+
+	return t->root != NULL && t->root->tags[tag] != 0;
+}
+
+/* Stores in ITEMS up to MAX entries of T with indexes of FIRST
+   or greater, in index order, and returns the number stored. */
+size_t
+radix_gang_lookup (struct radix_tree *t, uint64_t first,
+		void **items, size_t max) {
+	struct radix_iter i;
+	size_t cnt = 0;
+
+	radix_iter_init (&i, t, first, UINT64_MAX);
+	while (cnt < max && (items[cnt] = radix_iter_next (&i)) != NULL)
+		cnt++;
+	return cnt;
+}
+
+/* Stores in ITEMS up to MAX entries of T with TAG set and
+   indexes of FIRST or greater, in index order, and returns the
+   number stored. */
+size_t
+radix_gang_lookup_tag (struct radix_tree *t, uint64_t first,
+		void **items, size_t max, enum radix_tag tag) {
+	struct radix_iter i;
+	size_t cnt = 0;
+
+	radix_iter_init_tag (&i, t, first, UINT64_MAX, tag);
+	while (cnt < max && (items[cnt] = radix_iter_next (&i)) != NULL)
+		cnt++;
+	return cnt;
+}
+
+/* Initializes I for visiting the entries of T with indexes in
+   [FIRST, LAST], in index order.
+
+   Inserting into or deleting from T during iteration is allowed;
+   the iterator resumes after the index it last returned. */
+void
+radix_iter_init (struct radix_iter *i, struct radix_tree *t,
+		uint64_t first, uint64_t last) {
+	ASSERT (i != NULL);
+	ASSERT (t != NULL);
+
+	i->tree = t;
+	i->index = first;
+	i->next = first;
+	i->last = last;
+	i->tag = -1;
+	i->done = first > last;
+}
+
+/* Initializes I for visiting the entries of T with TAG set and
+   indexes in [FIRST, LAST], in index order. */
+void
+radix_iter_init_tag (struct radix_iter *i, struct radix_tree *t,
+		uint64_t first, uint64_t last, enum radix_tag tag) {
+	ASSERT (tag < RADIX_TAG_CNT);
+
+	radix_iter_init (i, t, first, last);
+	i->tag = tag;
+}
+
+/* Returns the next entry in I's range and sets I->index to its
+   index, or returns a null pointer if no entries are left. */
+void *
+radix_iter_next (struct radix_iter *i) {
+	void *item;
+
+	if (i->done)
+		return NULL;
+
+	item = find_next (i->tree, &i->next, i->last, i->tag);
+	if (item == NULL) {
+		i->done = true;
+		return NULL;
+	}
+
+	i->index = i->next;
+	if (i->index == i->last)
+		i->done = true;
+	else
+		i->next++;
+	return item;
+}
+
+/* Returns the number of entries in T. */
+size_t
+radix_size (struct radix_tree *t) {
+	return t->cnt;
+}
+
+/* Returns true if T has no entries, false otherwise. */
+bool
+radix_empty (struct radix_tree *t) {
+	return t->cnt == 0;
+}
+
+/* Allocates an empty node that sits at SHIFT in slot OFFSET of
+   PARENT.  Returns a null pointer if memory is exhausted. */
+static struct radix_node *
+node_alloc (unsigned shift, struct radix_node *parent, unsigned offset) {
+	struct radix_node *node = calloc (1, sizeof *node);
+
+	if (node != NULL) {
+		node->shift = shift;
+		node->offset = offset;
+		node->parent = parent;
+	}
+	return node;
+}
+
+/* Frees NODE and everything below it, calling DESTRUCTOR, if
+   non-null, on each entry.  BASE is the first index NODE
+   covers. */
+static void
+node_free_all (struct radix_node *node, radix_action_func *destructor,
+		uint64_t base) {
+	unsigned i;
+
+	for (i = 0; i < RADIX_SLOTS; i++) {
+		uint64_t index = base + ((uint64_t) i << node->shift);
+
+		if (node->slots[i] == NULL)
+			continue;
+		if (node->shift > 0)
+			node_free_all (node->slots[i], destructor, index);
+		else if (destructor != NULL)
+			destructor (node->slots[i], index);
+	}
+	free (node);
+}
+
+/* Returns the leaf of T whose range includes INDEX, or a null
+   pointer if there is none. */
+static struct radix_node *
+find_leaf (struct radix_tree *t, uint64_t index) {
+	struct radix_node *node = t->root;
+
+	if (node == NULL || index > max_index (node))
+		return NULL;
+	while (node != NULL && node->shift > 0)
+		node = node->slots[slot_of (node, index)];
+	return node;
+}
+
+/* Frees NODE and its ancestors while they are empty, then drops
+   root nodes whose only child is in slot 0. */
+static void
+prune (struct radix_tree *t, struct radix_node *node) {
+	while (node != NULL && node->count == 0) {
+		struct radix_node *parent = node->parent;
+
+		if (parent != NULL) {
+			parent->slots[node->offset] = NULL;
+			parent->count--;
+		} else
+			t->root = NULL;
+		free (node);
+		node = parent;
+	}
+
+	while (t->root != NULL && t->root->shift > 0
+			&& t->root->count == 1 && t->root->slots[0] != NULL) {
+		struct radix_node *root = t->root;
+
+		t->root = root->slots[0];
+		t->root->parent = NULL;
+		free (root);
+	}
+}
+
+/* Clears TAG on slot OFFSET of leaf NODE, and on its ancestors'
+   slots as their subtrees lose their last tagged entry.  Returns
+   true if the tag was set. */
+static bool
+clear_tag (struct radix_node *node, unsigned offset, unsigned tag) {
+	if (!((node->tags[tag] >> offset) & 1))
+		return false;
+
+	for (; node != NULL; offset = node->offset, node = node->parent) {
+		node->tags[tag] &= ~(1ULL << offset);
+		if (node->tags[tag] != 0)
+			break;
+	}
+	return true;
+}
+
+/* Returns the first slot of NODE at or after I that holds an
+   entry or subtree, with TAG set if TAG is not -1, or
+   RADIX_SLOTS if there is none. */
+static unsigned
+next_slot (const struct radix_node *node, unsigned i, int tag) {
+	if (tag >= 0) {
+		uint64_t bits = i < RADIX_SLOTS ? node->tags[tag] >> i << i : 0;
+		return bits != 0 ? (unsigned) __builtin_ctzll (bits) : RADIX_SLOTS;
+	}
+	while (i < RADIX_SLOTS && node->slots[i] == NULL)
+		i++;
+	return i;
+}
+
+/* Finds the entry in T with the least index in [*INDEX, LAST],
+   with TAG set if TAG is not -1.  If there is one, stores its
+   index in *INDEX and returns it.  Otherwise, returns a null
+   pointer. */
+static void *
+find_next (struct radix_tree *t, uint64_t *indexp, uint64_t last, int tag) {
+	struct radix_node *node = t->root;
+	uint64_t index = *indexp;
+	unsigned i;
+
+	if (node == NULL || index > last || index > max_index (node))
+		return NULL;
+
+	i = slot_of (node, index);
+	for (;;) {
+		unsigned j = next_slot (node, i, tag);
+		uint64_t start;
+
+		if (j == RADIX_SLOTS) {
+			/* Nothing left below NODE; go on with the parent's
+			   next slot. */
+			if (node->parent == NULL)
+				return NULL;
+			i = node->offset + 1;
+			node = node->parent;
+			continue;
+		}
+
+		/* Move INDEX up to the start of slot J, unless it is
+		   already within it. */
+		start = (index & ~(((uint64_t) RADIX_SLOTS << node->shift) - 1))
+			| ((uint64_t) j << node->shift);
+		if (start > index)
+			index = start;
+		if (index > last)
+			return NULL;
+
+		if (node->shift == 0) {
+			*indexp = index;
+			return node->slots[j];
+		}
+		node = node->slots[j];
+		i = slot_of (node, index);
+	}
+}
@@ -0,0 +1,403 @@
+/* Red-black tree.
+
+   See rbtree.h for basic information.  The balancing follows
+   Cormen, Leiserson, Rivest and Stein, "Introduction to
+   Algorithms", chapter 13, with null pointers in place of the
+   sentinel leaf. */
+
+#include "rbtree.h"
+#include "../debug.h"
+
+static void update_path (struct rb_tree *, struct rb_node *);
+static void replace_child (struct rb_tree *, struct rb_node *,
+		struct rb_node *);
+static void rotate_left (struct rb_tree *, struct rb_node *);
+static void rotate_right (struct rb_tree *, struct rb_node *);
+static void insert_fixup (struct rb_tree *, struct rb_node *);
+static void remove_fixup (struct rb_tree *, struct rb_node *,
+		struct rb_node *);
+
+/* Initializes T as an empty tree ordered by LESS, given
+   auxiliary data AUX. */
+void
+rb_init (struct rb_tree *t, rb_less_func *less, void *aux) {
+	rb_init_augmented (t, less, NULL, aux);
+}
+
+/* Initializes T as an empty tree ordered by LESS, given
+   auxiliary data AUX, whose nodes carry data that UPDATE
+   recomputes whenever a node's subtree changes. */
+void
+rb_init_augmented (struct rb_tree *t, rb_less_func *less,
+		rb_update_func *update, void *aux) {
+	ASSERT (t != NULL);
+	ASSERT (less != NULL);
+
+	t->root = NULL;
+	t->size = 0;
+	t->less = less;
+	t->update = update;
+	t->aux = aux;
+}
+
+/* Inserts N into T after any nodes equal to it. */
+void
+rb_insert (struct rb_tree *t, struct rb_node *n) {
+	struct rb_node **link = &t->root;
+	struct rb_node *parent = NULL;
+
+	ASSERT (n != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		link = t->less (n, parent, t->aux) ? &parent->left : &parent->right;
+	}
+
+	n->parent = parent;
+	n->left = n->right = NULL;
+	n->red = true;
+	*link = n;
+	t->size++;
+
+	/* Rotations keep the data of the subtree they rotate
+	   intact, so bringing N's ancestors up to date first is
+	   enough. */
+	update_path (t, n);
+	insert_fixup (t, n);
+}
+
+/* Removes N, which must be in T, from T. */
+void
+rb_remove (struct rb_tree *t, struct rb_node *n) {
+	struct rb_node *x, *x_parent;
+	bool removed_red;
+
+	ASSERT (n != NULL);
+
+	removed_red = n->red;
+
+	if (n->left == NULL || n->right == NULL) {
+		/* N has at most one child, which takes its place. */
+		x = n->left != NULL ? n->left : n->right;
+		x_parent = n->parent;
+		replace_child (t, n, x);
+	} else {
+		/* N's successor, which has no left child, takes its
+		   place. */
+		struct rb_node *y = n->right;
+
+		while (y->left != NULL)
+			y = y->left;
+		removed_red = y->red;
+		x = y->right;
+
+		if (y->parent == n)
+			x_parent = y;
+		else {
+			x_parent = y->parent;
+			replace_child (t, y, x);
+			y->right = n->right;
+			y->right->parent = y;
+		}
+		replace_child (t, n, y);
+		y->left = n->left;
+		y->left->parent = y;
+		y->red = n->red;
+	}
+	t->size--;
+
+	update_path (t, x_parent);
+	if (!removed_red)
+		remove_fixup (t, x, x_parent);
+}
+
+/* Returns the first node in T equal to KEY, or a null pointer if
+   there is none. */
+struct rb_node *
+rb_find (struct rb_tree *t, const struct rb_node *key) {
+	struct rb_node *n = rb_lower_bound (t, key);
+
+	return n != NULL && !t->less (key, n, t->aux) ? n : NULL;
+}
+
+/* Returns the first node in T that is not less than KEY, or a
+   null pointer if there is none. */
+struct rb_node *
+rb_lower_bound (struct rb_tree *t, const struct rb_node *key) {
+	struct rb_node *n = t->root;
+	struct rb_node *found = NULL;
+
+	while (n != NULL)
+		if (!t->less (n, key, t->aux)) {
+			found = n;
+			n = n->left;
+		} else
+			n = n->right;
+	return found;
+}
+
+/* Returns the first node in T that is greater than KEY, or a
+   null pointer if there is none. */
+struct rb_node *
+rb_upper_bound (struct rb_tree *t, const struct rb_node *key) {
+	struct rb_node *n = t->root;
+	struct rb_node *found = NULL;
+
+	while (n != NULL)
+		if (t->less (key, n, t->aux)) {
+			found = n;
+			n = n->left;
+		} else
+			n = n->right;
+	return found;
+}
+
+/* Returns the least node in T, or a null pointer if T is
+   empty. */
+struct rb_node *
+rb_first (struct rb_tree *t) {
+	struct rb_node *n = t->root;
+
+	if (n != NULL)
+		while (n->left != NULL)
+			n = n->left;
+	return n;
+}
+
+/* Returns the greatest node in T, or a null pointer if T is
+   empty. */
+struct rb_node *
+rb_last (struct rb_tree *t) {
+	struct rb_node *n = t->root;
+
+	if (n != NULL)
+		while (n->right != NULL)
+			n = n->right;
+	return n;
+}
+
+/* Returns the node after N in its tree, or a null pointer if N
+   is the last one. */
+struct rb_node *
+rb_next (struct rb_node *n) {
+	ASSERT (n != NULL);
+
+	if (n->right != NULL) {
+		n = n->right;
+		while (n->left != NULL)
+			n = n->left;
+		return n;
+	}
+	while (n->parent != NULL && n == n->parent->right)
+		n = n->parent;
+	return n->parent;
+}
+
+/* Returns the node before N in its tree, or a null pointer if N
+   is the first one. */
+struct rb_node *
+rb_prev (struct rb_node *n) {
+	ASSERT (n != NULL);
+
+	if (n->left != NULL) {
+		n = n->left;
+		while (n->right != NULL)
+			n = n->right;
+		return n;
+	}
+	while (n->parent != NULL && n == n->parent->left)
+		n = n->parent;
+	return n->parent;
+}
+
+/* Returns the number of nodes in T. */
+size_t
+rb_size (struct rb_tree *t) {
+	return t->size;
+}
+
+/* Returns true if T is empty, false otherwise. */
+bool
+rb_empty (struct rb_tree *t) {
+	return t->root == NULL;
+}
+
+/* Recomputes the augmented data of N and each of its ancestors,
+   if T is augmented. */
+static void
+update_path (struct rb_tree *t, struct rb_node *n) {
+	if (t->update != NULL)
+		for (; n != NULL; n = n->parent)
+			t->update (n, t->aux);
+}
+
+/* Puts NEW, which may be null, where OLD is in T. */
+static void
+replace_child (struct rb_tree *t, struct rb_node *old, struct rb_node *new) {
+	struct rb_node *parent = old->parent;
+
+	if (parent == NULL)
+		t->root = new;
+	else if (old == parent->left)
+		parent->left = new;
+	else
+		parent->right = new;
+	if (new != NULL)
+		new->parent = parent;
+}
+
+/* Rotates X's right child up into X's place in T. */
+static void
+rotate_left (struct rb_tree *t, struct rb_node *x) {
+	struct rb_node *y = x->right;
+
+	x->right = y->left;
+	if (y->left != NULL)
+		y->left->parent = x;
+	replace_child (t, x, y);
+	y->left = x;
+	x->parent = y;
+
+	if (t->update != NULL) {
+		t->update (x, t->aux);
+		t->update (y, t->aux);
+	}
+}
+
+/* Rotates X's left child up into X's place in T. */
+static void
+rotate_right (struct rb_tree *t, struct rb_node *x) {
+	struct rb_node *y = x->left;
+
+	x->left = y->right;
+	if (y->right != NULL)
+		y->right->parent = x;
+	replace_child (t, x, y);
+	y->right = x;
+	x->parent = y;
+
+	if (t->update != NULL) {
+		t->update (x, t->aux);
+		t->update (y, t->aux);
+	}
+}
+
+/* Returns true if N is a red node, false if it is black or
+   null. */
+static inline bool
+is_red (const struct rb_node *n) {
+	return n != NULL && n->red;
+}
+
+/* Restores the red-black properties of T after inserting red
+   node N. */
+static void
+insert_fixup (struct rb_tree *t, struct rb_node *n) {
+	struct rb_node *p;
+
+	while ((p = n->parent) != NULL && p->red) {
+		/* P is red, so it is not the root and has a parent. */
+		struct rb_node *g = p->parent;
+
+		if (p == g->left) {
+			struct rb_node *u = g->right;
+
+			if (is_red (u)) {
+				p->red = u->red = false;
+				g->red = true;
+				n = g;
+				continue;
+			}
+			if (n == p->right) {
+				rotate_left (t, p);
+				n = p;
+				p = n->parent;
+			}
+			p->red = false;
+			g->red = true;
+			rotate_right (t, g);
+		} else {
+			struct rb_node *u = g->left;
+
+			if (is_red (u)) {
+				p->red = u->red = false;
+				g->red = true;
+				n = g;
+				continue;
+			}
+			if (n == p->left) {
+				rotate_right (t, p);
+				n = p;
+				p = n->parent;
+			}
+			p->red = false;
+			g->red = true;
+			rotate_left (t, g);
+		}
+	}
+	t->root->red = false;
+}
+
+/* Restores the red-black properties of T after removing a black
+   node from above X, a child of PARENT.  X may be null. */
+static void
+remove_fixup (struct rb_tree *t, struct rb_node *x, struct rb_node *parent) {
+	while (x != t->root && !is_red (x)) {
+		/* X is short one black node, so its sibling W exists. */
+		if (x == parent->left) {
+			struct rb_node *w = parent->right;
+
+			if (w->red) {
+				w->red = false;
+				parent->red = true;
+				rotate_left (t, parent);
+				w = parent->right;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->right)) {
+					w->left->red = false;
+					w->red = true;
+					rotate_right (t, w);
+					w = parent->right;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->right->red = false;
+				rotate_left (t, parent);
+				x = t->root;
+			}
+		} else {
+			struct rb_node *w = parent->left;
+
+			if (w->red) {
+				w->red = false;
+				parent->red = true;
+				rotate_right (t, parent);
+				w = parent->left;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->left)) {
+					w->right->red = false;
+					w->red = true;
+					rotate_left (t, w);
+					w = parent->left;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->left->red = false;
+				rotate_right (t, parent);
+				x = t->root;
+			}
+		}
+	}
+	if (x != NULL)
+		x->red = false;
+}
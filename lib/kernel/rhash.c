@@ -0,0 +1,475 @@
+/* Open-addressing hash table.
+
+   See rhash.h for basic information. */
+
+#include "rhash.h"
+#include "../debug.h"
+#include "threads/malloc.h"
+#include "threads/vmalloc.h"
+
+/* Smallest number of slots in a table. */
+#define MIN_SLOTS 8
+
+/* Load limits, as fractions of the slot count.  The table grows
+   once more than 3/4 of the slots are in use and shrinks once
+   fewer than 1/8 are. */
+#define GROW_NUM   3
+#define GROW_DEN   4
+#define SHRINK_DEN 8
+
+/* Slots of the old array moved on each insertion or deletion
+   while a resize is in progress.  A grown table starts 3/8 full
+   and takes 3/8 of its slot count in insertions to fill up
+   again, by which time 4 slots per operation could have emptied
+   an old array half its size three times over. */
+#define MOVE_STEP 4
+
+static uint64_t elem_hash (struct rhash *, struct rhash_elem *);
+static size_t find_slot (struct rhash *, struct rhash_table *, uint64_t,
+		struct rhash_elem *);
+static struct rhash_table *find_elem (struct rhash *, uint64_t,
+		struct rhash_elem *, size_t *);
+static void place_elem (struct rhash_table *, uint64_t, struct rhash_elem *);
+static void remove_slot (struct rhash_table *, size_t);
+static void resize (struct rhash *);
+static void move_slots (struct rhash *, size_t);
+static struct rhash_slot *alloc_slots (size_t slot_cnt);
+static void free_slots (struct rhash_slot *);
+
+/* Initializes hash table H to compute hash values using HASH and
+   compare hash elements using LESS, given auxiliary data AUX. */
+bool
+rhash_init (struct rhash *h,
+		rhash_hash_func *hash, rhash_less_func *less, void *aux) {
+	h->elem_cnt = 0;
+	h->cur.slot_cnt = MIN_SLOTS;
+	h->cur.elem_cnt = 0;
+	h->cur.slots = alloc_slots (MIN_SLOTS);
+	h->old.slot_cnt = 0;
+	h->old.elem_cnt = 0;
+	h->old.slots = NULL;
+	h->move_idx = 0;
+	h->hash = hash;
+	h->less = less;
+	h->aux = aux;
+
+	return h->cur.slots != NULL;
+}
+
+/* Removes all the elements from H.
+
+   If DESTRUCTOR is non-null, then it is called for each element
+   in the hash.  DESTRUCTOR may, if appropriate, deallocate the
+   memory used by the hash element.  However, modifying hash
+   table H while rhash_clear() is running, using any of the
+   functions rhash_clear(), rhash_destroy(), rhash_insert(),
+   rhash_replace(), or rhash_delete(), yields undefined behavior,
+   whether done in DESTRUCTOR or elsewhere. */
+void
+rhash_clear (struct rhash *h, rhash_action_func *destructor) {
+	size_t i;
+
+	if (destructor != NULL)
+		rhash_apply (h, destructor);
+
+	if (h->old.slots != NULL) {
+		free_slots (h->old.slots);
+		h->old.slots = NULL;
+		h->old.slot_cnt = 0;
+		h->old.elem_cnt = 0;
+	}
+	for (i = 0; i < h->cur.slot_cnt; i++) {
+		h->cur.slots[i].hash = 0;
+		h->cur.slots[i].elem = NULL;
+	}
+	h->cur.elem_cnt = 0;
+	h->elem_cnt = 0;
+}
+
+/* Destroys hash table H.
+
+   If DESTRUCTOR is non-null, then it is first called for each
+   element in the hash.  DESTRUCTOR may, if appropriate,
+   deallocate the memory used by the hash element.  However,
+   modifying hash table H while rhash_clear() is running, using
+   any of the functions rhash_clear(), rhash_destroy(),
+   rhash_insert(), rhash_replace(), or rhash_delete(), yields
+   undefined behavior, whether done in DESTRUCTOR or
+   elsewhere. */
+void
+rhash_destroy (struct rhash *h, rhash_action_func *destructor) {
+	if (destructor != NULL)
+		rhash_apply (h, destructor);
+	if (h->old.slots != NULL)
+		free_slots (h->old.slots);
+	free_slots (h->cur.slots);
+}
+
+/* Inserts NEW into hash table H and returns a null pointer, if
+   no equal element is already in the table.
+   If an equal element is already in the table, returns it
+   without inserting NEW.
+
+   Panics if the table is full and cannot grow. */
+struct rhash_elem *
+rhash_insert (struct rhash *h, struct rhash_elem *new) {
+	uint64_t hash = elem_hash (h, new);
+	struct rhash_elem *old = NULL;
+	struct rhash_table *t;
+	size_t idx;
+
+	t = find_elem (h, hash, new, &idx);
+	if (t != NULL)
+		old = t->slots[idx].elem;
+	else {
+		h->elem_cnt++;
+		resize (h);
+		if (h->cur.elem_cnt == h->cur.slot_cnt)
+			PANIC ("rhash: table full and out of memory");
+		place_elem (&h->cur, hash, new);
+	}
+
+	move_slots (h, MOVE_STEP);
+
+	return old;
+}
+
+/* Inserts NEW into hash table H, replacing any equal element
+   already in the table, which is returned.  An element that is
+   replaced gives up its slot to NEW without any elements
+   moving. */
+struct rhash_elem *
+rhash_replace (struct rhash *h, struct rhash_elem *new) {
+	uint64_t hash = elem_hash (h, new);
+	struct rhash_elem *old;
+	struct rhash_table *t;
+	size_t idx;
+
+	t = find_elem (h, hash, new, &idx);
+	if (t == NULL)
+		return rhash_insert (h, new);
+
+	old = t->slots[idx].elem;
+	t->slots[idx].elem = new;
+	return old;
+}
+
+/* Finds and returns an element equal to E in hash table H, or a
+   null pointer if no equal element exists in the table. */
+struct rhash_elem *
+rhash_find (struct rhash *h, struct rhash_elem *e) {
+	struct rhash_table *t;
+	size_t idx;
+
+	t = find_elem (h, elem_hash (h, e), e, &idx);
+	return t != NULL ? t->slots[idx].elem : NULL;
+}
+
+/* Finds, removes, and returns an element equal to E in hash
+   table H.  Returns a null pointer if no equal element existed
+   in the table.
+
+   If the elements of the hash table are dynamically allocated,
+   or own resources that are, then it is the caller's
+   responsibility to deallocate them. */
+struct rhash_elem *
+rhash_delete (struct rhash *h, struct rhash_elem *e) {
+	struct rhash_elem *found;
+	struct rhash_table *t;
+	size_t idx;
+
+	t = find_elem (h, elem_hash (h, e), e, &idx);
+	if (t == NULL)
+		return NULL;
+
+	found = t->slots[idx].elem;
+	if (t == &h->cur)
+		remove_slot (t, idx);
+	else {
+		/* Keep the hash value so that probes for elements
+		   further along still walk past this slot. */
+		t->slots[idx].elem = NULL;
+		t->elem_cnt--;
+	}
+	h->elem_cnt--;
+
+	resize (h);
+	move_slots (h, MOVE_STEP);
+
+	return found;
+}
+
+/* Calls ACTION for each element in hash table H in arbitrary
+   order.
+   Modifying hash table H while rhash_apply() is running, using
+   any of the functions rhash_clear(), rhash_destroy(),
+   rhash_insert(), rhash_replace(), or rhash_delete(), yields
+   undefined behavior, whether done from ACTION or elsewhere. */
+void
+rhash_apply (struct rhash *h, rhash_action_func *action) {
+	struct rhash_iterator i;
+
+	ASSERT (action != NULL);
+
+	rhash_first (&i, h);
+	while (rhash_next (&i))
+		action (rhash_cur (&i), h->aux);
+}
+
+/* Initializes I for iterating hash table H.
+
+   Iteration idiom:
+
+   struct rhash_iterator i;
+
+   rhash_first (&i, h);
+   while (rhash_next (&i))
+   {
+   struct foo *f = rhash_entry (rhash_cur (&i), struct foo, elem);
+   ...do something with f...
+   }
+
+   Modifying hash table H during iteration, using any of the
+   functions rhash_clear(), rhash_destroy(), rhash_insert(),
+   rhash_replace(), or rhash_delete(), invalidates all
+   iterators. */
+void
+rhash_first (struct rhash_iterator *i, struct rhash *h) {
+	ASSERT (i != NULL);
+	ASSERT (h != NULL);
+
+	i->hash = h;
+	i->table = &h->cur;
+	i->idx = 0;
+	i->elem = NULL;
+}
+
+/* Advances I to the next element in the hash table and returns
+   it.  Returns a null pointer if no elements are left.  Elements
+   are returned in arbitrary order.
+
+   Modifying a hash table H during iteration, using any of the
+   functions rhash_clear(), rhash_destroy(), rhash_insert(),
+   rhash_replace(), or rhash_delete(), invalidates all
+   iterators. */
+struct rhash_elem *
+rhash_next (struct rhash_iterator *i) {
+	ASSERT (i != NULL);
+
+	for (;;) {
+		if (i->idx < i->table->slot_cnt) {
+			struct rhash_elem *e = i->table->slots[i->idx++].elem;
+			if (e != NULL)
+				return i->elem = e;
+		} else if (i->table == &i->hash->cur && i->hash->old.slots != NULL) {
+			i->table = &i->hash->old;
+			i->idx = 0;
+		} else
+			return i->elem = NULL;
+	}
+}
+
+/* Returns the current element in the hash table iteration, or a
+   null pointer at the end of the table.  Undefined behavior
+   after calling rhash_first() but before rhash_next(). */
+struct rhash_elem *
+rhash_cur (struct rhash_iterator *i) {
+	return i->elem;
+}
+
+/* Returns the number of elements in H. */
+size_t
+rhash_size (struct rhash *h) {
+	return h->elem_cnt;
+}
+
+/* Returns true if H contains no elements, false otherwise. */
+bool
+rhash_empty (struct rhash *h) {
+	return h->elem_cnt == 0;
+}
+
+/* Returns the hash value of E in H.  Zero marks an unused slot,
+   so it is folded into 1. */
+static uint64_t
+elem_hash (struct rhash *h, struct rhash_elem *e) {
+	uint64_t hash = h->hash (e, h->aux);
+	return hash != 0 ? hash : 1;
+}
+
+/* Returns how far slot IDX of T is from the home slot of HASH. */
+static inline size_t
+probe_dist (struct rhash_table *t, size_t idx, uint64_t hash) {
+	return (idx - hash) & (t->slot_cnt - 1);
+}
+
+/* Searches T in H for an element equal to E, whose hash value is
+   HASH.  Returns the index of its slot if found or SIZE_MAX
+   otherwise. */
+static size_t
+find_slot (struct rhash *h, struct rhash_table *t, uint64_t hash,
+		struct rhash_elem *e) {
+	size_t mask = t->slot_cnt - 1;
+	size_t idx = hash & mask;
+	size_t dist;
+
+	for (dist = 0; dist < t->slot_cnt; dist++, idx = (idx + 1) & mask) {
+		struct rhash_slot *s = &t->slots[idx];
+
+		/* An element nearer to its home slot than E would be
+		   means that E was never placed past it. */
+		if (s->hash == 0 || probe_dist (t, idx, s->hash) < dist)
+			break;
+		if (s->hash == hash && s->elem != NULL
+				&& !h->less (s->elem, e, h->aux)
+				&& !h->less (e, s->elem, h->aux))
+			return idx;
+	}
+	return SIZE_MAX;
+}
+
+/* Searches H for an element equal to E, whose hash value is
+   HASH.  If found, stores the index of its slot in *IDX and
+   returns the slot array that holds it.  Otherwise returns a
+   null pointer. */
+static struct rhash_table *
+find_elem (struct rhash *h, uint64_t hash, struct rhash_elem *e,
+		size_t *idx) {
+	*idx = find_slot (h, &h->cur, hash, e);
+	if (*idx != SIZE_MAX)
+		return &h->cur;
+	if (h->old.slots != NULL) {
+		*idx = find_slot (h, &h->old, hash, e);
+		if (*idx != SIZE_MAX)
+			return &h->old;
+	}
+	return NULL;
+}
+
+/* Puts E, whose hash value is HASH, into T, which must have a
+   free slot.  Each element met on the way that is nearer to its
+   home slot than the one being placed gives up its slot and is
+   carried on instead. */
+static void
+place_elem (struct rhash_table *t, uint64_t hash, struct rhash_elem *e) {
+	size_t mask = t->slot_cnt - 1;
+	size_t idx = hash & mask;
+	size_t dist = 0;
+
+	ASSERT (t->elem_cnt < t->slot_cnt);
+
+	t->elem_cnt++;
+	for (;; idx = (idx + 1) & mask, dist++) {
+		struct rhash_slot *s = &t->slots[idx];
+		size_t s_dist;
+
+		if (s->elem == NULL) {
+			s->hash = hash;
+			s->elem = e;
+			return;
+		}
+
+		s_dist = probe_dist (t, idx, s->hash);
+		if (s_dist < dist) {
+			struct rhash_slot tmp = *s;
+			s->hash = hash;
+			s->elem = e;
+			hash = tmp.hash;
+			e = tmp.elem;
+			dist = s_dist;
+		}
+	}
+}
+
+/* Empties slot IDX of T and shifts the elements after it, up to
+   the next free slot or element in its home slot, back by one. */
+static void
+remove_slot (struct rhash_table *t, size_t idx) {
+	size_t mask = t->slot_cnt - 1;
+	size_t next = (idx + 1) & mask;
+
+	t->elem_cnt--;
+	while (t->slots[next].elem != NULL
+			&& probe_dist (t, next, t->slots[next].hash) != 0) {
+		t->slots[idx] = t->slots[next];
+		idx = next;
+		next = (next + 1) & mask;
+	}
+	t->slots[idx].hash = 0;
+	t->slots[idx].elem = NULL;
+}
+
+/* Starts resizing H if its load is outside the limits.  The old
+   slot array is emptied a little at a time by move_slots().
+
+   This function can fail because of an out-of-memory condition,
+   but that'll just leave the table fuller or sparser than ideal;
+   we can still continue. */
+static void
+resize (struct rhash *h) {
+	size_t slot_cnt = h->cur.slot_cnt;
+	struct rhash_slot *slots;
+
+	if (h->elem_cnt * GROW_DEN > slot_cnt * GROW_NUM)
+		slot_cnt *= 2;
+	else if (slot_cnt > MIN_SLOTS && h->elem_cnt * SHRINK_DEN < slot_cnt)
+		slot_cnt /= 2;
+	else
+		return;
+
+	/* Only one old array can be kept, so finish any earlier
+	   resize before starting another. */
+	move_slots (h, SIZE_MAX);
+
+	slots = alloc_slots (slot_cnt);
+	if (slots == NULL)
+		return;
+
+	h->old = h->cur;
+	h->move_idx = 0;
+	h->cur.slot_cnt = slot_cnt;
+	h->cur.elem_cnt = 0;
+	h->cur.slots = slots;
+}
+
+/* Moves the elements in up to CNT slots of H's old slot array
+   into the current one, freeing the old array once it is
+   empty. */
+static void
+move_slots (struct rhash *h, size_t cnt) {
+	while (h->old.slots != NULL && cnt-- > 0) {
+		struct rhash_slot *s = &h->old.slots[h->move_idx++];
+
+		if (s->elem != NULL) {
+			place_elem (&h->cur, s->hash, s->elem);
+			s->elem = NULL;
+			h->old.elem_cnt--;
+		}
+
+		if (h->old.elem_cnt == 0 || h->move_idx == h->old.slot_cnt) {
+			free_slots (h->old.slots);
+			h->old.slots = NULL;
+			h->old.slot_cnt = 0;
+			h->old.elem_cnt = 0;
+		}
+	}
+}
+
+/* Allocates an array of SLOT_CNT empty slots.  Arrays too big for
+   a malloc() descriptor come from vmalloc(), as in hash.c. */
+static struct rhash_slot *
+alloc_slots (size_t slot_cnt) {
+	size_t size = sizeof (struct rhash_slot) * slot_cnt;
+
+	return size > PGSIZE / 2 ? vcalloc (slot_cnt, sizeof (struct rhash_slot))
+		: calloc (slot_cnt, sizeof (struct rhash_slot));
+}
+
+/* Frees SLOTS, allocated by alloc_slots(). */
+static void
+free_slots (struct rhash_slot *slots) {
+	if (is_vmalloc_vaddr (slots))
+		vfree (slots);
+	else
+		free (slots);
+}
@@ -1,5 +1,21 @@
 #include <string.h>
 #include <debug.h>
+#include <stdint.h>
+
+/* The block functions below move data a machine word at a time.
+   Large forward copies and fills use the string instructions
+   (rep movsq / rep stosq), which the CPU runs in wide internal
+   chunks; the remaining functions use plain word loops.  Words
+   are accessed through WORD_T, which may alias any object. */
+typedef uint64_t __attribute__ ((__may_alias__)) word_t;
+#define WORD_SIZE sizeof (word_t)
+
+/* Word with every byte set to 0x01 and to 0x80. */
+#define ONES  0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+
+/* Nonzero if word W contains a zero byte. */
+#define has_zero_byte(W) (((W) - ONES) & ~(W) & HIGHS)
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -7,12 +23,24 @@ void *
 memcpy (void *dst_, const void *src_, size_t size) {
 	unsigned char *dst = dst_;
 	const unsigned char *src = src_;
+	size_t head, words, tail;
 
 	ASSERT (dst != NULL || size == 0);
 	ASSERT (src != NULL || size == 0);
 
-	while (size-- > 0)
-		*dst++ = *src++;
+	/* Bring DST to a word boundary, copy whole words, then the
+	   tail. */
+	head = -(uintptr_t) dst & (WORD_SIZE - 1);
+	if (head > size)
+		head = size;
+	words = (size - head) / WORD_SIZE;
+	tail = (size - head) % WORD_SIZE;
+	asm volatile ("rep movsb"
+			: "+D" (dst), "+S" (src), "+c" (head) : : "memory");
+	asm volatile ("rep movsq"
+			: "+D" (dst), "+S" (src), "+c" (words) : : "memory");
+	asm volatile ("rep movsb"
+			: "+D" (dst), "+S" (src), "+c" (tail) : : "memory");
 
 	return dst_;
 }
@@ -27,17 +55,22 @@ memmove (void *dst_, const void *src_, size_t size) {
 	ASSERT (dst != NULL || size == 0);
 	ASSERT (src != NULL || size == 0);
 
-	if (dst < src) {
-		while (size-- > 0)
-			*dst++ = *src++;
-	} else {
-		dst += size;
-		src += size;
-		while (size-- > 0)
-			*--dst = *--src;
+	if (dst <= src || dst >= src + size)
+		return memcpy (dst_, src_, size);
+
+	/* DST overlaps the end of SRC: copy backward, the tail bytes
+	   first and then whole words. */
+	dst += size;
+	src += size;
+	for (; size % WORD_SIZE != 0; size--)
+		*--dst = *--src;
+	for (; size > 0; size -= WORD_SIZE) {
+		dst -= WORD_SIZE;
+		src -= WORD_SIZE;
+		*(word_t *) dst = *(const word_t *) src;
 	}
 
-	return dst;
+	return dst_;
 }
 
 /* Find the first differing byte in the two blocks of SIZE bytes
@@ -52,6 +85,11 @@ memcmp (const void *a_, const void *b_, size_t size) {
 	ASSERT (a != NULL || size == 0);
 	ASSERT (b != NULL || size == 0);
 
+	/* Skip the equal prefix a word at a time. */
+	for (; size >= WORD_SIZE; a += WORD_SIZE, b += WORD_SIZE, size -= WORD_SIZE)
+		if (*(const word_t *) a != *(const word_t *) b)
+			break;
+
 	for (; size-- > 0; a++, b++)
 		if (*a != *b)
 			return *a > *b ? +1 : -1;
@@ -257,11 +295,24 @@ strtok_r (char *s, const char *delimiters, char **save_ptr) {
 void *
 memset (void *dst_, int value, size_t size) {
 	unsigned char *dst = dst_;
+	uint64_t pattern = (unsigned char) value * ONES;
+	size_t head, words, tail;
 
 	ASSERT (dst != NULL || size == 0);
 
-	while (size-- > 0)
-		*dst++ = value;
+	/* Bring DST to a word boundary, store whole words, then the
+	   tail. */
+	head = -(uintptr_t) dst & (WORD_SIZE - 1);
+	if (head > size)
+		head = size;
+	words = (size - head) / WORD_SIZE;
+	tail = (size - head) % WORD_SIZE;
+	asm volatile ("rep stosb"
+			: "+D" (dst), "+c" (head) : "a" (pattern) : "memory");
+	asm volatile ("rep stosq"
+			: "+D" (dst), "+c" (words) : "a" (pattern) : "memory");
+	asm volatile ("rep stosb"
+			: "+D" (dst), "+c" (tail) : "a" (pattern) : "memory");
 
 	return dst_;
 }
@@ -270,10 +321,19 @@ memset (void *dst_, int value, size_t size) {
 size_t
 strlen (const char *string) {
 	const char *p;
+	const word_t *w;
 
 	ASSERT (string);
 
-	for (p = string; *p != '\0'; p++)
+	/* Check bytes up to a word boundary, then whole words.  An
+	   aligned word never crosses a page, so reading past the
+	   terminator cannot fault. */
+	for (p = string; (uintptr_t) p % WORD_SIZE != 0; p++)
+		if (*p == '\0')
+			return p - string;
+	for (w = (const word_t *) p; !has_zero_byte (*w); w++)
+		continue;
+	for (p = (const char *) w; *p != '\0'; p++)
 		continue;
 	return p - string;
 }
@@ -3,11 +3,49 @@
 #include <syscall.h>
 #include <syscall-nr.h>
 
+/* Buffering modes. */
+enum buf_mode {
+	BUF_UNKNOWN,        /* Not yet determined. */
+	BUF_LINE,           /* Flush after each call that writes a new-line. */
+	BUF_FULL,           /* Flush only when the buffer fills up. */
+	BUF_NONE            /* Flush after every call. */
+};
+
+/* A buffered output stream. */
+struct __stream {
+	int handle;             /* Output file handle. */
+	enum buf_mode mode;     /* Buffering mode. */
+	char *buf;              /* Character buffer. */
+	size_t size;            /* Size of BUF. */
+	size_t used;            /* Number of characters in BUF. */
+	bool newline;           /* New-line added since last flush? */
+};
+
+/* Standard output is line buffered on the console and fully
+   buffered when it has been redirected to a file.  Pintos has
+   no separate error handle, so standard error goes to the same
+   handle unbuffered. */
+static char stdout_buf[1024];
+static char stderr_buf[64];
+static FILE stdout_stream = {
+	STDOUT_FILENO, BUF_UNKNOWN, stdout_buf, sizeof stdout_buf, 0, false
+};
+static FILE stderr_stream = {
+	STDOUT_FILENO, BUF_NONE, stderr_buf, sizeof stderr_buf, 0, false
+};
+FILE *stdout = &stdout_stream;
+FILE *stderr = &stderr_stream;
+
+static void stream_begin (FILE *);
+static void stream_end (FILE *);
+static void stream_putc (FILE *, char);
+static void add_char (char, void *);
+
 /* The standard vprintf() function,
    which is like printf() but uses a va_list. */
 int
 vprintf (const char *format, va_list args) {
-	return vhprintf (STDOUT_FILENO, format, args);
+	return vfprintf (stdout, format, args);
 }
 
 /* Like printf(), but writes output to the given HANDLE. */
@@ -23,12 +61,28 @@ hprintf (int handle, const char *format, ...) {
 	return retval;
 }
 
+/* Like printf(), but writes output to STREAM. */
+int
+fprintf (FILE *stream, const char *format, ...) {
+	va_list args;
+	int retval;
+
+	va_start (args, format);
+	retval = vfprintf (stream, format, args);
+	va_end (args);
+
+	return retval;
+}
+
 /* Writes string S to the console, followed by a new-line
    character. */
 int
 puts (const char *s) {
-	write (STDOUT_FILENO, s, strlen (s));
-	putchar ('\n');
+	stream_begin (stdout);
+	while (*s != '\0')
+		stream_putc (stdout, *s++);
+	stream_putc (stdout, '\n');
+	stream_end (stdout);
 
 	return 0;
 }
@@ -36,51 +90,144 @@ puts (const char *s) {
 /* Writes C to the console. */
 int
 putchar (int c) {
-	char c2 = c;
-	write (STDOUT_FILENO, &c2, 1);
+	return fputc (c, stdout);
+}
+
+/* Writes string S to STREAM. */
+int
+fputs (const char *s, FILE *stream) {
+	stream_begin (stream);
+	while (*s != '\0')
+		stream_putc (stream, *s++);
+	stream_end (stream);
+
+	return 0;
+}
+
+/* Writes C to STREAM. */
+int
+fputc (int c, FILE *stream) {
+	stream_begin (stream);
+	stream_putc (stream, c);
+	stream_end (stream);
+
 	return c;
 }
 
-/* Auxiliary data for vhprintf_helper(). */
+/* Writes out whatever STREAM has buffered, or the buffers of
+   every stream if STREAM is null.  Returns 0 if successful,
+   EOF otherwise. */
+int
+fflush (FILE *stream) {
+	if (stream == NULL) {
+		fflush (stdout);
+		return fflush (stderr);
+	}
+
+	size_t used = stream->used;
+
+	stream->used = 0;
+	stream->newline = false;
+	if (used > 0 && write (stream->handle, stream->buf, used) != (int) used)
+		return EOF;
+	return 0;
+}
+
+/* Flushes every stream and forgets how each one is buffered,
+   because the handle underneath may now refer to something
+   else.  Called before a program changes or gives up its file
+   handles. */
+void
+__stdio_reset (void) {
+	fflush (NULL);
+	if (stdout->mode != BUF_NONE)
+		stdout->mode = BUF_UNKNOWN;
+}
+
+/* Auxiliary data for formatting to a handle without a stream
+   of its own. */
 struct vhprintf_aux {
+	FILE stream;        /* Unbuffered stream over BUF. */
 	char buf[64];       /* Character buffer. */
-	char *p;            /* Current position in buffer. */
-	int char_cnt;       /* Total characters written so far. */
-	int handle;         /* Output file handle. */
 };
 
-static void add_char (char, void *);
-static void flush (struct vhprintf_aux *);
-
 /* Formats the printf() format specification FORMAT with
    arguments given in ARGS and writes the output to the given
    HANDLE. */
 int
 vhprintf (int handle, const char *format, va_list args) {
 	struct vhprintf_aux aux;
-	aux.p = aux.buf;
+
+	if (handle == STDOUT_FILENO)
+		return vfprintf (stdout, format, args);
+
+	aux.stream.handle = handle;
+	aux.stream.mode = BUF_NONE;
+	aux.stream.buf = aux.buf;
+	aux.stream.size = sizeof aux.buf;
+	aux.stream.used = 0;
+	aux.stream.newline = false;
+	return vfprintf (&aux.stream, format, args);
+}
+
+/* Auxiliary data for vfprintf()'s add_char(). */
+struct vfprintf_aux {
+	FILE *stream;       /* Output stream. */
+	int char_cnt;       /* Total characters written so far. */
+};
+
+/* Formats the printf() format specification FORMAT with
+   arguments given in ARGS and writes the output to STREAM. */
+int
+vfprintf (FILE *stream, const char *format, va_list args) {
+	struct vfprintf_aux aux;
+
+	aux.stream = stream;
 	aux.char_cnt = 0;
-	aux.handle = handle;
+	stream_begin (stream);
 	__vprintf (format, args, add_char, &aux);
-	flush (&aux);
+	stream_end (stream);
 	return aux.char_cnt;
 }
 
-/* Adds C to the buffer in AUX, flushing it if the buffer fills
-   up. */
+/* Adds C to the stream in AUX. */
 static void
 add_char (char c, void *aux_) {
-	struct vhprintf_aux *aux = aux_;
-	*aux->p++ = c;
-	if (aux->p >= aux->buf + sizeof aux->buf)
-		flush (aux);
+	struct vfprintf_aux *aux = aux_;
+	stream_putc (aux->stream, c);
 	aux->char_cnt++;
 }
 
-/* Flushes the buffer in AUX. */
+/* Prepares STREAM for output. */
+static void
+stream_begin (FILE *stream) {
+	/* The console reports no file size, which tells it apart
+	   from a file that the handle has been redirected to. */
+	if (stream->mode == BUF_UNKNOWN)
+		stream->mode = filesize (stream->handle) < 0 ? BUF_LINE : BUF_FULL;
+
+	/* Keep unbuffered output in order with what stdout holds. */
+	if (stream->mode == BUF_NONE && stream != stdout
+			&& stream->handle == stdout->handle)
+		fflush (stdout);
+}
+
+/* Finishes a call that wrote to STREAM, flushing it if its
+   buffering mode says to. */
+static void
+stream_end (FILE *stream) {
+	if (stream->mode == BUF_NONE
+			|| (stream->mode == BUF_LINE && stream->newline))
+		fflush (stream);
+}
+
+/* Adds C to STREAM's buffer, flushing it if the buffer fills
+   up. */
 static void
-flush (struct vhprintf_aux *aux) {
-	if (aux->p > aux->buf)
-		write (aux->handle, aux->buf, aux->p - aux->buf);
-	aux->p = aux->buf;
+stream_putc (FILE *stream, char c) {
+	stream->buf[stream->used++] = c;
+	if (c == '\n')
+		stream->newline = true;
+	if (stream->used >= stream->size)
+		fflush (stream);
 }
@@ -1,5 +1,6 @@
 #include <syscall.h>
 #include <stdint.h>
+#include <stdio.h>
 #include "../syscall-nr.h"
 
 __attribute__((always_inline))
@@ -54,7 +55,7 @@ static __inline int64_t syscall (uint64_t num_, uint64_t a1_, uint64_t a2_,
 			((uint64_t) ARG2), 0, 0, 0))
 
 #define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3) ( \
-		syscall(((uint64_t *) NUMBER), \
+		syscall(((uint64_t) NUMBER), \
 			((uint64_t) ARG0), \
 			((uint64_t) ARG1), \
 			((uint64_t) ARG2), \
@@ -70,23 +71,29 @@ static __inline int64_t syscall (uint64_t num_, uint64_t a1_, uint64_t a2_,
 			0))
 void
 halt (void) {
+	fflush (NULL);
 	syscall0 (SYS_HALT);
 	NOT_REACHED ();
 }
 
 void
 exit (int status) {
+	/* Output still buffered in this process would be lost. */
+	fflush (NULL);
 	syscall1 (SYS_EXIT, status);
 	NOT_REACHED ();
 }
 
 pid_t
 fork (const char *thread_name){
+	/* Otherwise the child would write the same output again. */
+	fflush (NULL);
 	return (pid_t) syscall1 (SYS_FORK, thread_name);
 }
 
 int
 exec (const char *file) {
+	fflush (NULL);
 	return (pid_t) syscall1 (SYS_EXEC, file);
 }
 
@@ -137,11 +144,15 @@ tell (int fd) {
 
 void
 close (int fd) {
+	if (fd == STDOUT_FILENO)
+		__stdio_reset ();
 	syscall1 (SYS_CLOSE, fd);
 }
 
 int
 dup2 (int oldfd, int newfd){
+	if (newfd == STDOUT_FILENO)
+		__stdio_reset ();
 	return syscall2 (SYS_DUP2, oldfd, newfd);
 }
 
@@ -194,3 +205,67 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+bool
+memstat (struct memstat *ms) {
+	return syscall1 (SYS_MEMSTAT, ms);
+}
+
+int
+dmesg (char *buffer, unsigned size) {
+	return syscall2 (SYS_DMESG, buffer, size);
+}
+
+bool
+sysstat (int nr, struct sysstat *st) {
+	return syscall2 (SYS_SYSSTAT, nr, st);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt) {
+	return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt) {
+	return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+int
+pread (int fd, void *buffer, unsigned size, off_t offset) {
+	return syscall4 (SYS_PREAD, fd, buffer, size, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned size, off_t offset) {
+	return syscall4 (SYS_PWRITE, fd, buffer, size, offset);
+}
+
+int
+copy_file_range (int fd_in, off_t *ofs_in, int fd_out, off_t *ofs_out,
+		unsigned size) {
+	return syscall5 (SYS_COPY_FILE_RANGE, fd_in, ofs_in, fd_out, ofs_out, size);
+}
+
+pid_t
+spawn (const char *cmd_line, const struct spawn_action *actions,
+		int action_cnt) {
+	/* Keep our output ahead of the child's. */
+	fflush (NULL);
+	return (pid_t) syscall3 (SYS_SPAWN, cmd_line, actions, action_cnt);
+}
+
+int
+pipe (int fds[2]) {
+	return syscall1 (SYS_PIPE, fds);
+}
+
+int
+poll (struct pollfd *fds, unsigned nfds, int timeout) {
+	return syscall3 (SYS_POLL, fds, nfds, timeout);
+}
+
+int
+uring_enter (struct uring *ring, unsigned to_submit) {
+	return syscall2 (SYS_URING_ENTER, ring, to_submit);
+}
@@ -0,0 +1,234 @@
+/* Test program for lib/kernel/radix.c.
+
+   Inserts and deletes entries at a mix of small, large and
+   extreme indexes, sets and clears tags on them, and checks
+   lookups, gang lookups and range iteration against a plain
+   array after each step.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <radix.h>
+#include <random.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Number of distinct indexes used. */
+#define KEY_CNT 256
+
+/* Number of random operations. */
+#define OP_CNT 20000
+
+/* An entry. */
+struct entry
+  {
+    uint64_t index;             /* Index in the tree. */
+    bool present;               /* In the tree? */
+    bool tags[RADIX_TAG_CNT];   /* Tags expected to be set. */
+  };
+
+/* Entries, sorted by index. */
+static struct entry entries[KEY_CNT];
+
+static void make_keys (void);
+static void verify (struct radix_tree *, size_t cnt);
+static void verify_scan (struct radix_tree *, uint64_t first, uint64_t last,
+                         int tag);
+
+/* Test the radix tree implementation. */
+void
+test (void)
+{
+  struct radix_tree tree;
+  size_t cnt = 0;
+  int op;
+
+  printf ("testing radix tree:");
+  make_keys ();
+  radix_init (&tree);
+  for (op = 0; op < OP_CNT; op++)
+    {
+      struct entry *e = &entries[random_ulong () % KEY_CNT];
+      enum radix_tag tag = random_ulong () % RADIX_TAG_CNT;
+
+      switch (random_ulong () % 4)
+        {
+        case 0:
+        case 1:
+          /* Insert or delete. */
+          if (e->present)
+            {
+              ASSERT (!radix_insert (&tree, e->index, e));
+              ASSERT (radix_delete (&tree, e->index) == e);
+              e->tags[0] = e->tags[1] = false;
+              cnt--;
+            }
+          else
+            {
+              ASSERT (radix_delete (&tree, e->index) == NULL);
+              ASSERT (radix_insert (&tree, e->index, e));
+              cnt++;
+            }
+          e->present = !e->present;
+          break;
+
+        case 2:
+          /* Set a tag. */
+          if (e->present)
+            {
+              radix_tag_set (&tree, e->index, tag);
+              e->tags[tag] = true;
+            }
+          break;
+
+        case 3:
+          /* Clear a tag. */
+          radix_tag_clear (&tree, e->index, tag);
+          e->tags[tag] = false;
+          break;
+        }
+
+      if (op % 100 == 0)
+        verify (&tree, cnt);
+      if (op % (OP_CNT / 10) == 0)
+        printf (" %zu", cnt);
+    }
+  verify (&tree, cnt);
+  radix_destroy (&tree, NULL);
+  ASSERT (radix_empty (&tree));
+  printf (" done\n");
+}
+
+/* Fills ENTRIES with distinct indexes in increasing order: dense
+   small ones, sparse large ones, and the extremes. */
+static void
+make_keys (void)
+{
+  int i, j;
+
+  for (i = 0; i < KEY_CNT; i++)
+    {
+      uint64_t index;
+      bool dup;
+
+      do
+        {
+          switch (i == 0 ? -1 : i % 4)
+            {
+            case -1:
+              index = 0;
+              break;
+            case 0:
+              index = random_ulong () % 4096;
+              break;
+            case 1:
+              index = (uint64_t) random_ulong () << 20;
+              break;
+            case 2:
+              index = ((uint64_t) random_ulong () << 32) ^ random_ulong ();
+              break;
+            default:
+              index = UINT64_MAX - random_ulong () % 64;
+              break;
+            }
+          dup = false;
+          for (j = 0; j < i; j++)
+            if (entries[j].index == index)
+              dup = true;
+        }
+      while (dup);
+      entries[i].index = index;
+    }
+
+  /* Insertion sort. */
+  for (i = 1; i < KEY_CNT; i++)
+    for (j = i; j > 0 && entries[j - 1].index > entries[j].index; j--)
+      {
+        struct entry t = entries[j];
+        entries[j] = entries[j - 1];
+        entries[j - 1] = t;
+      }
+}
+
+/* Checks that TREE holds exactly the CNT present entries with
+   the expected tags, and checks some ordered scans. */
+static void
+verify (struct radix_tree *tree, size_t cnt)
+{
+  int i, tag;
+
+  ASSERT (radix_size (tree) == cnt);
+  for (i = 0; i < KEY_CNT; i++)
+    {
+      struct entry *e = &entries[i];
+
+      ASSERT (radix_lookup (tree, e->index) == (e->present ? e : NULL));
+      for (tag = 0; tag < RADIX_TAG_CNT; tag++)
+        ASSERT (radix_tag_get (tree, e->index, tag) == e->tags[tag]);
+    }
+
+  for (tag = -1; tag < RADIX_TAG_CNT; tag++)
+    {
+      bool any = false;
+
+      for (i = 0; i < KEY_CNT; i++)
+        if (entries[i].present && (tag < 0 || entries[i].tags[tag]))
+          any = true;
+      ASSERT (tag < 0 || radix_tagged (tree, tag) == any);
+
+      verify_scan (tree, 0, UINT64_MAX, tag);
+      for (i = 0; i < 4; i++)
+        {
+          struct entry *a = &entries[random_ulong () % KEY_CNT];
+          struct entry *b = &entries[random_ulong () % KEY_CNT];
+          uint64_t first = a->index - random_ulong () % 2;
+          uint64_t last = b->index + random_ulong () % 2;
+
+          verify_scan (tree, first, last, tag);
+        }
+    }
+}
+
+/* Checks that iterating over [FIRST, LAST], and gang lookups from
+   FIRST, return the present entries in that range, tagged with
+   TAG if it is not -1, in order. */
+static void
+verify_scan (struct radix_tree *tree, uint64_t first, uint64_t last, int tag)
+{
+  static void *gang[KEY_CNT];
+  struct radix_iter it;
+  size_t gang_cnt, seen = 0;
+  void *item;
+  int i;
+
+  if (tag < 0)
+    {
+      radix_iter_init (&it, tree, first, last);
+      gang_cnt = radix_gang_lookup (tree, first, gang, KEY_CNT);
+    }
+  else
+    {
+      radix_iter_init_tag (&it, tree, first, last, tag);
+      gang_cnt = radix_gang_lookup_tag (tree, first, gang, KEY_CNT, tag);
+    }
+
+  for (i = 0; i < KEY_CNT; i++)
+    {
+      struct entry *e = &entries[i];
+
+      if (!e->present || (tag >= 0 && !e->tags[tag]) || e->index < first)
+        continue;
+      if (e->index <= last)
+        {
+          item = radix_iter_next (&it);
+          ASSERT (item == e && it.index == e->index);
+        }
+      ASSERT (seen < gang_cnt && gang[seen] == e);
+      seen++;
+    }
+  ASSERT (radix_iter_next (&it) == NULL);
+  ASSERT (seen == gang_cnt);
+}
@@ -0,0 +1,279 @@
+/* Test program for lib/kernel/rbtree.c and lib/kernel/itree.c.
+
+   Builds trees of various sizes from shuffled values, including
+   duplicates, and checks the red-black properties, the order of
+   traversal and the results of searches after every insertion
+   and removal.  Then checks interval tree overlap queries
+   against a linear scan.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <itree.h>
+#include <random.h>
+#include <rbtree.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of elements in a tree that we will test. */
+#define MAX_SIZE 64
+
+/* Number of ranges, and largest range end, for the interval
+   tree test. */
+#define RANGE_CNT 128
+#define RANGE_MAX 512
+
+/* A red-black tree element. */
+struct value
+  {
+    struct rb_node node;        /* Tree node. */
+    int value;                  /* Item value. */
+    int seq;                    /* Insertion order. */
+  };
+
+/* An interval tree element. */
+struct range
+  {
+    struct itree_node node;     /* Tree node. */
+    bool present;               /* In the tree? */
+  };
+
+static void shuffle (struct value *[], size_t);
+static bool value_less (const struct rb_node *, const struct rb_node *,
+                        void *);
+static int verify_subtree (struct rb_node *);
+static void verify_tree (struct rb_tree *, size_t size);
+static void test_rbtree (void);
+static void test_itree (void);
+
+/* Test the red-black and interval tree implementations. */
+void
+test (void)
+{
+  test_rbtree ();
+  test_itree ();
+}
+
+/* Inserts and removes shuffled values, with every value present
+   twice, in trees up to MAX_SIZE elements. */
+static void
+test_rbtree (void)
+{
+  int size;
+
+  printf ("testing various size trees:");
+  for (size = 0; size < MAX_SIZE; size++)
+    {
+      int repeat;
+
+      printf (" %d", size);
+      for (repeat = 0; repeat < 10; repeat++)
+        {
+          static struct value values[MAX_SIZE];
+          static struct value *order[MAX_SIZE];
+          struct rb_tree tree;
+          struct value key;
+          int i;
+
+          /* Put values 0...SIZE/2 twice in VALUES, and pointers to
+             them in random order in ORDER. */
+          for (i = 0; i < size; i++)
+            {
+              values[i].value = i / 2;
+              order[i] = &values[i];
+            }
+          shuffle (order, size);
+
+          /* Assemble tree. */
+          rb_init (&tree, value_less, NULL);
+          for (i = 0; i < size; i++)
+            {
+              order[i]->seq = i;
+              rb_insert (&tree, &order[i]->node);
+              verify_tree (&tree, i + 1);
+            }
+
+          /* Check searches. */
+          for (i = -1; i <= size / 2; i++)
+            {
+              struct rb_node *lower, *upper, *found;
+
+              key.value = i;
+              lower = rb_lower_bound (&tree, &key.node);
+              upper = rb_upper_bound (&tree, &key.node);
+              found = rb_find (&tree, &key.node);
+              if (i < 0)
+                {
+                  ASSERT (found == NULL && lower == rb_first (&tree)
+                          && upper == lower);
+                }
+              else if (i * 2 < size)
+                {
+                  ASSERT (found == lower);
+                  ASSERT (rb_entry (lower, struct value, node)->value == i);
+                  ASSERT (upper == (i * 2 + 1 < size
+                                    ? rb_next (rb_next (lower))
+                                    : rb_next (lower)));
+                }
+              else
+                {
+                  ASSERT (found == NULL);
+                  ASSERT (lower == NULL && upper == NULL);
+                }
+            }
+
+          /* Remove in random order. */
+          shuffle (order, size);
+          for (i = 0; i < size; i++)
+            {
+              rb_remove (&tree, &order[i]->node);
+              verify_tree (&tree, size - i - 1);
+            }
+          ASSERT (rb_empty (&tree));
+        }
+    }
+  printf (" done\n");
+}
+
+/* Inserts, removes and queries random ranges, comparing each
+   query with a scan of all the ranges in the tree. */
+static void
+test_itree (void)
+{
+  static struct range ranges[RANGE_CNT];
+  struct itree tree;
+  size_t cnt = 0;
+  int op;
+
+  printf ("testing interval tree:");
+  itree_init (&tree);
+  for (op = 0; op < 10000; op++)
+    {
+      struct range *r = &ranges[random_ulong () % RANGE_CNT];
+      uint64_t start = random_ulong () % RANGE_MAX;
+      uint64_t end = start + 1 + random_ulong () % 32;
+      struct itree_node *n;
+      uint64_t last_start = 0;
+      size_t expected = 0, found = 0;
+      int i;
+
+      if (op % 1000 == 0)
+        printf (" %zu", cnt);
+
+      /* Flip one range in or out of the tree. */
+      if (r->present)
+        {
+          itree_remove (&tree, &r->node);
+          cnt--;
+        }
+      else
+        {
+          uint64_t r_start = random_ulong () % RANGE_MAX;
+          itree_insert (&tree, &r->node, r_start,
+                        r_start + 1 + random_ulong () % 32);
+          cnt++;
+        }
+      r->present = !r->present;
+      ASSERT (itree_size (&tree) == cnt);
+      verify_subtree (tree.rb_tree.root);
+
+      /* Query [START, END). */
+      for (i = 0; i < RANGE_CNT; i++)
+        if (ranges[i].present
+            && ranges[i].node.start < end && ranges[i].node.end > start)
+          expected++;
+      for (n = itree_first (&tree, start, end); n != NULL;
+           n = itree_next (n, start, end))
+        {
+          ASSERT (itree_entry (n, struct range, node)->present);
+          ASSERT (n->start < end && n->end > start);
+          ASSERT (n->start >= last_start);
+          last_start = n->start;
+          found++;
+        }
+      ASSERT (found == expected);
+    }
+  printf (" done\n");
+}
+
+/* Shuffles the CNT elements in ARRAY into random order. */
+static void
+shuffle (struct value **array, size_t cnt)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      size_t j = i + random_ulong () % (cnt - i);
+      struct value *t = array[j];
+      array[j] = array[i];
+      array[i] = t;
+    }
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool
+value_less (const struct rb_node *a_, const struct rb_node *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = rb_entry (a_, struct value, node);
+  const struct value *b = rb_entry (b_, struct value, node);
+
+  return a->value < b->value;
+}
+
+/* Checks the links and colors below N and returns the number of
+   black nodes on every path from N to a leaf. */
+static int
+verify_subtree (struct rb_node *n)
+{
+  int left, right;
+
+  if (n == NULL)
+    return 1;
+  ASSERT (!n->red || ((n->left == NULL || !n->left->red)
+                       && (n->right == NULL || !n->right->red)));
+  ASSERT (n->left == NULL || n->left->parent == n);
+  ASSERT (n->right == NULL || n->right->parent == n);
+
+  left = verify_subtree (n->left);
+  right = verify_subtree (n->right);
+  ASSERT (left == right);
+  return left + !n->red;
+}
+
+/* Checks that TREE is a valid red-black tree of SIZE values,
+   that it visits them in order in both directions, and that
+   equal values come out in insertion order. */
+static void
+verify_tree (struct rb_tree *tree, size_t size)
+{
+  struct rb_node *n, *prev = NULL;
+  size_t cnt = 0;
+
+  ASSERT (tree->root == NULL || !tree->root->red);
+  ASSERT (tree->root == NULL || tree->root->parent == NULL);
+  verify_subtree (tree->root);
+  ASSERT (rb_size (tree) == size);
+
+  for (n = rb_first (tree); n != NULL; n = rb_next (n))
+    {
+      if (prev != NULL)
+        {
+          const struct value *a = rb_entry (prev, struct value, node);
+          const struct value *b = rb_entry (n, struct value, node);
+
+          ASSERT (a->value < b->value
+                  || (a->value == b->value && a->seq < b->seq));
+          ASSERT (rb_prev (n) == prev);
+        }
+      prev = n;
+      cnt++;
+    }
+  ASSERT (cnt == size);
+  ASSERT (prev == rb_last (tree));
+}
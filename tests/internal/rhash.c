@@ -0,0 +1,239 @@
+/* Test program for lib/kernel/rhash.c.
+
+   Runs random insertions, deletions and lookups against a table
+   while tracking which elements should be present, then times
+   the open-addressing table against the chained one in
+   lib/kernel/hash.c on a workload shaped like a supplemental
+   page table: one element per user page, keyed by its address.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <random.h>
+#include <rhash.h>
+#include <stdio.h>
+#include "threads/test.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Number of distinct elements used for the random test. */
+#define VERIFY_SIZE 2048
+
+/* Number of random operations. */
+#define VERIFY_OPS 200000
+
+/* Pages in the timed workload: a 16 MB process. */
+#define BENCH_PAGES 4096
+
+/* A page, as a supplemental page table would track it. */
+struct page
+  {
+    void *va;                   /* User virtual address. */
+    struct hash_elem helem;     /* Element in chained table. */
+    struct rhash_elem relem;    /* Element in open-addressing table. */
+    bool present;               /* In the table under test? */
+  };
+
+static struct page pages[BENCH_PAGES];
+
+static uint64_t page_hash (const struct hash_elem *, void *);
+static bool page_less (const struct hash_elem *, const struct hash_elem *,
+                       void *);
+static uint64_t page_rhash (const struct rhash_elem *, void *);
+static bool page_rless (const struct rhash_elem *, const struct rhash_elem *,
+                        void *);
+static void init_pages (size_t);
+static void verify (void);
+static void bench (void);
+
+/* Test the open-addressing hash table. */
+void
+test (void)
+{
+  verify ();
+  bench ();
+}
+
+/* Applies random operations to a table, checking each result and
+   the element count against the PRESENT flags.  Phases that
+   mostly insert alternate with phases that mostly delete, so the
+   table grows and shrinks repeatedly while resizes are still in
+   progress. */
+static void
+verify (void)
+{
+  struct rhash h;
+  size_t cnt = 0;
+  int op;
+
+  printf ("verifying open-addressing table:");
+  init_pages (VERIFY_SIZE);
+  ASSERT (rhash_init (&h, page_rhash, page_rless, NULL));
+  for (op = 0; op < VERIFY_OPS; op++)
+    {
+      struct page *p = &pages[random_ulong () % VERIFY_SIZE];
+      bool growing = (op / (VERIFY_OPS / 10)) % 2 == 0;
+      int kind = random_ulong () % 4;
+      struct rhash_elem *e;
+
+      if (kind == 0)
+        {
+          e = rhash_find (&h, &p->relem);
+          ASSERT (p->present ? e == &p->relem : e == NULL);
+        }
+      else if (growing ? kind != 1 : kind == 1)
+        {
+          e = rhash_insert (&h, &p->relem);
+          ASSERT (p->present ? e == &p->relem : e == NULL);
+          if (!p->present)
+            cnt++;
+          p->present = true;
+        }
+      else
+        {
+          e = rhash_delete (&h, &p->relem);
+          ASSERT (p->present ? e == &p->relem : e == NULL);
+          if (p->present)
+            cnt--;
+          p->present = false;
+        }
+      ASSERT (rhash_size (&h) == cnt);
+
+      if (op % (VERIFY_OPS / 10) == 0)
+        {
+          struct rhash_iterator i;
+          size_t seen = 0;
+
+          printf (" %zu", cnt);
+          rhash_first (&i, &h);
+          while (rhash_next (&i))
+            {
+              ASSERT (rhash_entry (rhash_cur (&i), struct page,
+                                   relem)->present);
+              seen++;
+            }
+          ASSERT (seen == cnt);
+        }
+    }
+  rhash_destroy (&h, NULL);
+  printf (" done\n");
+}
+
+/* Times inserting, finding and deleting BENCH_PAGES pages with
+   each table.  Besides the totals, reports the slowest single
+   insertion, where the chained table rehashes every element at
+   once. */
+static void
+bench (void)
+{
+  struct hash h;
+  struct rhash rh;
+  uint64_t start, cycles, insert, find, delete, worst;
+  size_t i;
+
+  init_pages (BENCH_PAGES);
+
+  ASSERT (hash_init (&h, page_hash, page_less, NULL));
+  insert = worst = 0;
+  for (i = 0; i < BENCH_PAGES; i++)
+    {
+      start = rdtsc ();
+      hash_insert (&h, &pages[i].helem);
+      cycles = rdtsc () - start;
+      insert += cycles;
+      if (cycles > worst)
+        worst = cycles;
+    }
+  start = rdtsc ();
+  for (i = 0; i < BENCH_PAGES; i++)
+    ASSERT (hash_find (&h, &pages[i].helem) != NULL);
+  find = rdtsc () - start;
+  start = rdtsc ();
+  for (i = 0; i < BENCH_PAGES; i++)
+    hash_delete (&h, &pages[i].helem);
+  delete = rdtsc () - start;
+  hash_destroy (&h, NULL);
+  printf ("chained:         insert %llu, find %llu, delete %llu "
+          "cycles/page, worst insert %llu cycles\n",
+          insert / BENCH_PAGES, find / BENCH_PAGES, delete / BENCH_PAGES,
+          worst);
+
+  ASSERT (rhash_init (&rh, page_rhash, page_rless, NULL));
+  insert = worst = 0;
+  for (i = 0; i < BENCH_PAGES; i++)
+    {
+      start = rdtsc ();
+      rhash_insert (&rh, &pages[i].relem);
+      cycles = rdtsc () - start;
+      insert += cycles;
+      if (cycles > worst)
+        worst = cycles;
+    }
+  start = rdtsc ();
+  for (i = 0; i < BENCH_PAGES; i++)
+    ASSERT (rhash_find (&rh, &pages[i].relem) != NULL);
+  find = rdtsc () - start;
+  start = rdtsc ();
+  for (i = 0; i < BENCH_PAGES; i++)
+    rhash_delete (&rh, &pages[i].relem);
+  delete = rdtsc () - start;
+  rhash_destroy (&rh, NULL);
+  printf ("open-addressing: insert %llu, find %llu, delete %llu "
+          "cycles/page, worst insert %llu cycles\n",
+          insert / BENCH_PAGES, find / BENCH_PAGES, delete / BENCH_PAGES,
+          worst);
+}
+
+/* Gives the first CNT pages consecutive user addresses. */
+static void
+init_pages (size_t cnt)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      pages[i].va = (void *) (0x400000 + i * PGSIZE);
+      pages[i].present = false;
+    }
+}
+
+/* Returns a hash of the page holding chained element E. */
+static uint64_t
+page_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct page *p = hash_entry (e, struct page, helem);
+  return hash_bytes (&p->va, sizeof p->va);
+}
+
+/* Orders the pages holding chained elements A and B by
+   address. */
+static bool
+page_less (const struct hash_elem *a, const struct hash_elem *b,
+           void *aux UNUSED)
+{
+  return hash_entry (a, struct page, helem)->va
+         < hash_entry (b, struct page, helem)->va;
+}
+
+/* Returns a hash of the page holding open-addressing element
+   E. */
+static uint64_t
+page_rhash (const struct rhash_elem *e, void *aux UNUSED)
+{
+  const struct page *p = rhash_entry (e, struct page, relem);
+  return hash_bytes (&p->va, sizeof p->va);
+}
+
+/* Orders the pages holding open-addressing elements A and B by
+   address. */
+static bool
+page_rless (const struct rhash_elem *a, const struct rhash_elem *b,
+            void *aux UNUSED)
+{
+  return rhash_entry (a, struct page, relem)->va
+         < rhash_entry (b, struct page, relem)->va;
+}
@@ -0,0 +1,180 @@
+/* Test program for the block functions in lib/string.c.
+
+   Checks memcpy(), memmove(), memset(), memcmp() and strlen()
+   against simple byte-at-a-time versions for every small size
+   and alignment, then times both versions on page-sized buffers
+   to show the throughput of the word-sized implementations.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/test.h"
+#include "intrinsic.h"
+
+/* Largest block size checked for correctness. */
+#define MAX_SIZE 80
+
+/* Size of the buffers used for timing, and rounds to time. */
+#define BENCH_SIZE 4096
+#define BENCH_ROUNDS 256
+
+static void *byte_memcpy (void *, const void *, size_t);
+static void *byte_memset (void *, int, size_t);
+static int sign (int);
+static void fill_random (unsigned char *, size_t);
+static void verify (void);
+static void bench (void);
+
+/* Test the string block functions. */
+void
+test (void)
+{
+  verify ();
+  bench ();
+}
+
+/* Compares each function with its byte-wise reference for all
+   sizes up to MAX_SIZE and all source and destination offsets
+   within a word. */
+static void
+verify (void)
+{
+  static unsigned char src[MAX_SIZE + 16], a[MAX_SIZE + 16], b[MAX_SIZE + 16];
+  size_t size, s_ofs, d_ofs, i;
+
+  printf ("verifying block functions:");
+  for (size = 0; size <= MAX_SIZE; size++)
+    {
+      printf (" %zu", size);
+      for (s_ofs = 0; s_ofs < 8; s_ofs++)
+        for (d_ofs = 0; d_ofs < 8; d_ofs++)
+          {
+            fill_random (src, sizeof src);
+            fill_random (a, sizeof a);
+            byte_memcpy (b, a, sizeof a);
+
+            /* memcpy. */
+            ASSERT (memcpy (a + d_ofs, src + s_ofs, size) == a + d_ofs);
+            byte_memcpy (b + d_ofs, src + s_ofs, size);
+            ASSERT (!memcmp (a, b, sizeof a));
+
+            /* memmove, in both directions. */
+            byte_memcpy (b, a, sizeof a);
+            ASSERT (memmove (a + d_ofs, a + s_ofs, size) == a + d_ofs);
+            for (i = 0; i < size; i++)
+              {
+                size_t k = d_ofs <= s_ofs ? i : size - 1 - i;
+                b[d_ofs + k] = b[s_ofs + k];
+              }
+            ASSERT (!memcmp (a, b, sizeof a));
+
+            /* memset. */
+            ASSERT (memset (a + d_ofs, s_ofs * 37, size) == a + d_ofs);
+            byte_memset (b + d_ofs, s_ofs * 37, size);
+            ASSERT (!memcmp (a, b, sizeof a));
+
+            /* memcmp, with one byte changed. */
+            if (size > 0)
+              {
+                size_t pos = random_ulong () % size;
+                int cmp;
+
+                b[d_ofs + pos] ^= 1 + random_ulong () % 255;
+                cmp = a[d_ofs + pos] < b[d_ofs + pos] ? -1 : 1;
+                ASSERT (sign (memcmp (a + d_ofs, b + d_ofs, size)) == cmp);
+              }
+
+            /* strlen. */
+            byte_memset (a, 'x', sizeof a);
+            a[d_ofs + size] = '\0';
+            if (s_ofs <= d_ofs + size)
+              {
+                size_t len = strlen ((char *) a + s_ofs);
+                ASSERT (len == d_ofs + size - s_ofs);
+              }
+          }
+    }
+  printf (" done\n");
+}
+
+/* Times page-sized copies and fills with both the byte-wise and
+   the lib/string.c versions and prints their throughput. */
+static void
+bench (void)
+{
+  static unsigned char a[BENCH_SIZE], b[BENCH_SIZE];
+  uint64_t start, byte_cycles, word_cycles;
+  int i;
+
+  start = rdtsc ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    byte_memcpy (a, b, BENCH_SIZE);
+  byte_cycles = rdtsc () - start;
+  start = rdtsc ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memcpy (a, b, BENCH_SIZE);
+  word_cycles = rdtsc () - start;
+  printf ("memcpy: %llu bytes/kcycle byte-wise, %llu bytes/kcycle\n",
+          BENCH_SIZE * BENCH_ROUNDS * 1000ULL / byte_cycles,
+          BENCH_SIZE * BENCH_ROUNDS * 1000ULL / word_cycles);
+  ASSERT (word_cycles < byte_cycles);
+
+  start = rdtsc ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    byte_memset (a, i, BENCH_SIZE);
+  byte_cycles = rdtsc () - start;
+  start = rdtsc ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memset (a, i, BENCH_SIZE);
+  word_cycles = rdtsc () - start;
+  printf ("memset: %llu bytes/kcycle byte-wise, %llu bytes/kcycle\n",
+          BENCH_SIZE * BENCH_ROUNDS * 1000ULL / byte_cycles,
+          BENCH_SIZE * BENCH_ROUNDS * 1000ULL / word_cycles);
+  ASSERT (word_cycles < byte_cycles);
+}
+
+/* Byte-at-a-time memcpy(), the reference implementation. */
+static void *
+byte_memcpy (void *dst_, const void *src_, size_t size)
+{
+  unsigned char *dst = dst_;
+  const unsigned char *src = src_;
+
+  while (size-- > 0)
+    *dst++ = *src++;
+  return dst_;
+}
+
+/* Byte-at-a-time memset(), the reference implementation. */
+static void *
+byte_memset (void *dst_, int value, size_t size)
+{
+  unsigned char *dst = dst_;
+
+  while (size-- > 0)
+    *dst++ = value;
+  return dst_;
+}
+
+/* Returns -1, 0 or 1 according to the sign of X. */
+static int
+sign (int x)
+{
+  return (x > 0) - (x < 0);
+}
+
+/* Fills the SIZE bytes at P with random values. */
+static void
+fill_random (unsigned char *p, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = random_ulong ();
+}
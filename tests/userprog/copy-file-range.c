@@ -0,0 +1,47 @@
+/* Copies a file into another inside the kernel with
+   copy_file_range, first using and moving the file positions and
+   then at explicit offsets, and checks the copies. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* SAMPLE twice, the expected contents of "copy.txt". */
+static char expected[(sizeof sample - 1) * 2];
+
+void
+test_main (void) 
+{
+  int in, out, byte_cnt;
+  off_t ofs_in, ofs_out;
+
+  CHECK ((in = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (create ("copy.txt", (sizeof sample - 1) * 2), "create \"copy.txt\"");
+  CHECK ((out = open ("copy.txt")) > 1, "open \"copy.txt\"");
+
+  /* Whole file, through the file positions. */
+  byte_cnt = copy_file_range (in, NULL, out, NULL, 4096);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("copy_file_range() returned %d", byte_cnt);
+  if (tell (in) != sizeof sample - 1 || tell (out) != sizeof sample - 1)
+    fail ("file positions not advanced");
+
+  /* Again at explicit offsets, in two pieces. */
+  ofs_in = 0;
+  ofs_out = sizeof sample - 1;
+  byte_cnt = copy_file_range (in, &ofs_in, out, &ofs_out, 100);
+  byte_cnt += copy_file_range (in, &ofs_in, out, &ofs_out, 4096);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("copy_file_range() at offsets returned %d", byte_cnt);
+  if (ofs_in != sizeof sample - 1 || ofs_out != (sizeof sample - 1) * 2)
+    fail ("offsets not advanced");
+  if (tell (out) != sizeof sample - 1)
+    fail ("copy at offsets moved the file position");
+  close (out);
+
+  memcpy (expected, sample, sizeof sample - 1);
+  memcpy (expected + (sizeof sample - 1), sample, sizeof sample - 1);
+  check_file ("copy.txt", expected, sizeof expected);
+}
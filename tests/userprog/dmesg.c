@@ -0,0 +1,28 @@
+/* Writes a line to the console, then reads it back out of the
+   kernel log with dmesg, both into a large buffer and into one
+   too small to hold it. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char buf[4096];
+  const char *line = "a line for the kernel log";
+  int len;
+
+  msg ("%s", line);
+
+  len = dmesg (buf, sizeof buf - 1);
+  CHECK (len > 0, "dmesg");
+  buf[len] = '\0';
+  if (strstr (buf, line) == NULL)
+    fail ("kernel log lacks the line just written");
+
+  len = dmesg (buf, 8);
+  if (len < 0 || len > 8)
+    fail ("dmesg() returned %d for an 8-byte buffer", len);
+}
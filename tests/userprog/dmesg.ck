@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(dmesg) begin
+(dmesg) a line for the kernel log
+(dmesg) dmesg
+(dmesg) end
+dmesg: exit(0)
+EOF
+pass;
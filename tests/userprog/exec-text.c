@@ -0,0 +1,34 @@
+/* Runs a second copy of this program and has it check that it
+   shares its read-only text pages with the first one: it must
+   have taken fewer pages from the user pool than it maps. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+int
+main (int argc, char *argv[]) 
+{
+  struct memstat ms;
+  char cmd_line[64];
+
+  test_name = "exec-text";
+  if (argc == 2)
+    {
+      /* The second copy reports through its exit status, since
+         its output would interleave with the first's. */
+      size_t before = atoi (argv[1]);
+
+      if (!memstat (&ms) || ms.user_used - before >= ms.rss)
+        return 1;
+      return 81;
+    }
+
+  msg ("begin");
+  CHECK (memstat (&ms), "memstat");
+  snprintf (cmd_line, sizeof cmd_line, "exec-text %zu", ms.user_used);
+  msg ("wait(spawn()) = %d", wait (spawn (cmd_line, NULL, 0)));
+  msg ("end");
+  return 0;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-text) begin
+(exec-text) memstat
+exec-text: exit(81)
+(exec-text) wait(spawn()) = 81
+(exec-text) end
+exec-text: exit(0)
+EOF
+pass;
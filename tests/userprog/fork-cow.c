@@ -0,0 +1,53 @@
+/* Forks a process with a large data segment and checks that the
+   child shares it with the parent until one of them writes to it,
+   and that writes in the child do not show through in the
+   parent. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define DATA_PAGES 128
+#define PAGE_SIZE 4096
+
+static char data[DATA_PAGES * PAGE_SIZE];
+
+void
+test_main (void) 
+{
+  struct memstat before, after;
+  size_t i;
+  int pid;
+
+  for (i = 0; i < sizeof data; i++)
+    data[i] = i % 251;
+
+  CHECK (memstat (&before), "memstat");
+  if ((pid = fork ("child")))
+    {
+      int status = wait (pid);
+      msg ("Parent: child exit status is %d", status);
+      for (i = 0; i < sizeof data; i++)
+        if (data[i] != (char) (i % 251))
+          fail ("data[%zu] changed to %d in parent", i, data[i]);
+      msg ("parent data intact");
+    }
+  else
+    {
+      /* Only the pages touched since the fork, such as the stack,
+         may have been copied. */
+      memstat (&after);
+      if (after.user_used - before.user_used >= DATA_PAGES / 2)
+        fail ("fork copied %zu pages", after.user_used - before.user_used);
+      msg ("child shares the parent's pages");
+
+      for (i = 0; i < sizeof data; i += PAGE_SIZE)
+        data[i] = ~data[i];
+      memstat (&after);
+      if (after.user_used - before.user_used < DATA_PAGES)
+        fail ("writes copied only %zu pages",
+              after.user_used - before.user_used);
+      msg ("child writes got private copies");
+      exit (81);
+    }
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-cow) begin
+(fork-cow) memstat
+(fork-cow) child shares the parent's pages
+(fork-cow) child writes got private copies
+child: exit(81)
+(fork-cow) Parent: child exit status is 81
+(fork-cow) parent data intact
+(fork-cow) end
+fork-cow: exit(0)
+EOF
+pass;
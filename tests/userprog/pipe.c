@@ -0,0 +1,60 @@
+/* Passes data from a child to its parent through a pipe.  The
+   child writes several times the pipe's capacity, so it has to
+   block until the parent makes room, then closes its end so the
+   parent sees EOF.  Finally checks that writing to a pipe with no
+   reader fails. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define DATA_SIZE (3 * 4096 + 123)
+
+static char buf[1000];
+
+void
+test_main (void) 
+{
+  int fds[2];
+  int pid, size, n, i;
+
+  CHECK (pipe (fds) == 0, "pipe");
+
+  if ((pid = fork ("child")) == 0)
+    {
+      close (fds[0]);
+      for (size = 0; size < DATA_SIZE; size += n)
+        {
+          n = DATA_SIZE - size < (int) sizeof buf ? DATA_SIZE - size : (int) sizeof buf;
+          for (i = 0; i < n; i++)
+            buf[i] = (size + i) % 251;
+          if (write (fds[1], buf, n) != n)
+            exit (1);
+        }
+      exit (0);
+    }
+
+  /* Don't print until the child has exited, to keep the output
+     in a predictable order. */
+  close (fds[1]);
+  size = 0;
+  while ((n = read (fds[0], buf, sizeof buf)) > 0)
+    {
+      for (i = 0; i < n; i++)
+        if (buf[i] != (char) ((size + i) % 251))
+          fail ("byte %d read as %d", size + i, buf[i]);
+      size += n;
+    }
+  if (n < 0)
+    fail ("read() returned %d", n);
+  if (wait (pid) != 0)
+    fail ("child failed to write");
+  if (size != DATA_SIZE)
+    fail ("read %d bytes instead of %d", size, DATA_SIZE);
+  msg ("read %d bytes", size);
+  close (fds[0]);
+
+  CHECK (pipe (fds) == 0, "pipe");
+  close (fds[0]);
+  CHECK (write (fds[1], buf, 1) == -1, "write with no reader");
+}
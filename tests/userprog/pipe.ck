@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe) begin
+(pipe) pipe
+child: exit(0)
+(pipe) read 12411 bytes
+(pipe) pipe
+(pipe) write with no reader
+(pipe) end
+pipe: exit(0)
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* Polls the two ends of a pipe, plus an invalid descriptor, as
+   the pipe fills and empties, times out on an empty pipe, and
+   wakes up when a child writes to the pipe or closes it. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct pollfd fds[3];
+  int p[2];
+  int pid;
+  char c;
+
+  CHECK (pipe (p) == 0, "pipe");
+  fds[0].fd = p[0];
+  fds[0].events = POLLIN;
+  fds[1].fd = p[1];
+  fds[1].events = POLLOUT;
+  fds[2].fd = 100;
+  fds[2].events = POLLIN;
+
+  CHECK (poll (fds, 3, 0) == 2, "poll empty pipe");
+  if (fds[0].revents != 0 || fds[1].revents != POLLOUT
+      || fds[2].revents != POLLNVAL)
+    fail ("wrong events %d %d %d",
+          fds[0].revents, fds[1].revents, fds[2].revents);
+
+  CHECK (poll (fds, 1, 50) == 0, "poll times out");
+
+  CHECK (write (p[1], "x", 1) == 1, "write");
+  CHECK (poll (fds, 1, -1) == 1, "poll readable pipe");
+  if (fds[0].revents != POLLIN)
+    fail ("wrong events %d", fds[0].revents);
+  CHECK (read (p[0], &c, 1) == 1 && c == 'x', "read");
+
+  /* Don't print until the child has exited, to keep the output
+     in a predictable order. */
+  if ((pid = fork ("child")) == 0)
+    {
+      write (p[1], "y", 1);
+      exit (0);
+    }
+  if (poll (fds, 1, -1) != 1 || fds[0].revents != POLLIN)
+    fail ("poll did not see the child's write");
+  if (read (p[0], &c, 1) != 1 || c != 'y')
+    fail ("read the wrong byte");
+  if (wait (pid) != 0)
+    fail ("child failed");
+  msg ("woken by child");
+
+  close (p[1]);
+  CHECK (poll (fds, 1, -1) == 1 && fds[0].revents == POLLHUP,
+         "poll closed pipe");
+}
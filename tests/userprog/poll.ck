@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll) begin
+(poll) pipe
+(poll) poll empty pipe
+(poll) poll times out
+(poll) write
+(poll) poll readable pipe
+(poll) read
+child: exit(0)
+(poll) woken by child
+(poll) poll closed pipe
+(poll) end
+poll: exit(0)
+EOF
+pass;
@@ -0,0 +1,42 @@
+/* Writes and reads a file at explicit offsets with pwrite and
+   pread, and checks that neither moves the file position. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char buf[sizeof sample];
+  size_t half = (sizeof sample - 1) / 2;
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", sizeof sample - 1), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  /* Write the second half first, then the first. */
+  byte_cnt = pwrite (handle, sample + half, sizeof sample - 1 - half, half);
+  if (byte_cnt != (int) (sizeof sample - 1 - half))
+    fail ("pwrite() returned %d", byte_cnt);
+  byte_cnt = pwrite (handle, sample, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pwrite() returned %d", byte_cnt);
+  if (tell (handle) != 0)
+    fail ("pwrite() moved the file position to %u", tell (handle));
+
+  seek (handle, 5);
+  byte_cnt = pread (handle, buf, sizeof buf, 0);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("pread() returned %d", byte_cnt);
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "test.txt");
+  if (tell (handle) != 5)
+    fail ("pread() moved the file position to %u", tell (handle));
+
+  byte_cnt = pread (handle, buf, 10, sizeof sample + 100);
+  if (byte_cnt != 0)
+    fail ("pread() past end of file returned %d", byte_cnt);
+  msg ("positional I/O ok");
+}
@@ -0,0 +1,52 @@
+/* Writes and reads back a file through page-aligned buffers,
+   which the kernel moves straight between the file and the
+   user pages, with a partial page on the end and then with a
+   misaligned buffer, which go through the ordinary copy. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE 4096
+#define SIZE (PAGE * 2 + 100)
+
+static char src[PAGE * 3] __attribute__ ((aligned (PAGE)));
+static char dst[PAGE * 3] __attribute__ ((aligned (PAGE)));
+
+void
+test_main (void) 
+{
+  int handle, byte_cnt;
+  size_t i;
+
+  for (i = 0; i < sizeof src; i++)
+    src[i] = i * 7 + i / PAGE;
+
+  CHECK (create ("pages", SIZE), "create \"pages\"");
+  CHECK ((handle = open ("pages")) > 1, "open \"pages\"");
+
+  byte_cnt = write (handle, src, SIZE);
+  if (byte_cnt != SIZE)
+    fail ("write() returned %d instead of %d", byte_cnt, SIZE);
+
+  msg ("read aligned");
+  seek (handle, 0);
+  byte_cnt = read (handle, dst, SIZE);
+  if (byte_cnt != SIZE)
+    fail ("read() returned %d instead of %d", byte_cnt, SIZE);
+  compare_bytes (dst, src, SIZE, 0, "pages");
+
+  msg ("read misaligned");
+  seek (handle, 0);
+  byte_cnt = read (handle, dst + 1, PAGE * 2);
+  if (byte_cnt != PAGE * 2)
+    fail ("read() returned %d instead of %d", byte_cnt, PAGE * 2);
+  compare_bytes (dst + 1, src, PAGE * 2, 0, "pages");
+
+  msg ("read past end");
+  seek (handle, PAGE);
+  byte_cnt = read (handle, dst, PAGE * 2);
+  if (byte_cnt != SIZE - PAGE)
+    fail ("read() returned %d instead of %d", byte_cnt, SIZE - PAGE);
+  compare_bytes (dst, src + PAGE, SIZE - PAGE, PAGE, "pages");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-write-page) begin
+(read-write-page) create "pages"
+(read-write-page) open "pages"
+(read-write-page) read aligned
+(read-write-page) read misaligned
+(read-write-page) read past end
+(read-write-page) end
+read-write-page: exit(0)
+EOF
+pass;
@@ -0,0 +1,87 @@
+/* Writes a file from several buffers with writev, reads it back
+   into differently split buffers with readv, checks that readv
+   from a pipe returns what is there instead of waiting to fill
+   its later buffers, and writes a line to the console in
+   pieces. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+void
+test_main (void) 
+{
+  static char payload[6000];
+  static char back[sizeof payload + 16];
+  char header[] = "header:";
+  char trailer[] = ":trailer";
+  char head_back[4];
+  struct iovec iov[3];
+  size_t later_lens[2] = {PAGE_SIZE - 3, sizeof back};
+  int handle, byte_cnt, fds[2];
+  size_t i, total = strlen (header) + sizeof payload + strlen (trailer);
+
+  for (i = 0; i < sizeof payload; i++)
+    payload[i] = 'a' + i % 26;
+
+  CHECK (create ("vec", total), "create \"vec\"");
+  CHECK ((handle = open ("vec")) > 1, "open \"vec\"");
+
+  iov[0].iov_base = header;
+  iov[0].iov_len = strlen (header);
+  iov[1].iov_base = payload;
+  iov[1].iov_len = sizeof payload;
+  iov[2].iov_base = trailer;
+  iov[2].iov_len = strlen (trailer);
+  byte_cnt = writev (handle, iov, 3);
+  if (byte_cnt != (int) total)
+    fail ("writev() returned %d instead of %zu", byte_cnt, total);
+
+  seek (handle, 0);
+  iov[0].iov_base = head_back;
+  iov[0].iov_len = sizeof head_back;
+  iov[1].iov_base = back;
+  iov[1].iov_len = sizeof back;
+  byte_cnt = readv (handle, iov, 2);
+  if (byte_cnt != (int) total)
+    fail ("readv() returned %d instead of %zu", byte_cnt, total);
+  if (memcmp (head_back, "head", 4)
+      || memcmp (back, "er:", 3)
+      || memcmp (back + 3, payload, sizeof payload)
+      || memcmp (back + 3 + sizeof payload, trailer, strlen (trailer)))
+    fail ("readv() read back the wrong data");
+  msg ("file contents match");
+
+  /* A short first buffer, then a buffer that takes a separate
+     read, once in the batched path and once in the direct path.
+     The write end stays open, so a read that waits would never
+     return. */
+  CHECK (pipe (fds) == 0, "pipe");
+  for (i = 0; i < 2; i++)
+    {
+      if (write (fds[1], "0123456789", 10) != 10)
+        fail ("write() to pipe failed");
+      iov[0].iov_base = head_back;
+      iov[0].iov_len = sizeof head_back;
+      iov[1].iov_base = back;
+      iov[1].iov_len = later_lens[i];
+      byte_cnt = readv (fds[0], iov, 2);
+      if (byte_cnt != 10)
+        fail ("readv() from pipe returned %d instead of 10", byte_cnt);
+      if (memcmp (head_back, "0123", 4) || memcmp (back, "456789", 6))
+        fail ("readv() from pipe read the wrong data");
+    }
+  msg ("pipe contents match");
+
+  iov[0].iov_base = "(readv-writev) ";
+  iov[0].iov_len = strlen (iov[0].iov_base);
+  iov[1].iov_base = "console ";
+  iov[1].iov_len = strlen (iov[1].iov_base);
+  iov[2].iov_base = "in pieces\n";
+  iov[2].iov_len = strlen (iov[2].iov_base);
+  writev (STDOUT_FILENO, iov, 3);
+}
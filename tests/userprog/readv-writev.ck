@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "vec"
+(readv-writev) open "vec"
+(readv-writev) file contents match
+(readv-writev) pipe
+(readv-writev) pipe contents match
+(readv-writev) console in pieces
+(readv-writev) end
+readv-writev: exit(0)
+EOF
+pass;
@@ -0,0 +1,41 @@
+/* Spawns child-simple twice: once as is, and once with its
+   stdout redirected into a pipe by the spawn actions, in which
+   case the parent reads the child's message from the pipe.  Also
+   checks that spawning a missing program fails. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct spawn_action actions[3];
+  char buf[64];
+  int p[2];
+  int pid, n;
+
+  msg ("wait(spawn()) = %d", wait (spawn ("child-simple", NULL, 0)));
+
+  CHECK (pipe (p) == 0, "pipe");
+  actions[0].op = SPAWN_DUP2;
+  actions[0].fd = p[1];
+  actions[0].newfd = 1;
+  actions[1].op = SPAWN_CLOSE;
+  actions[1].fd = p[0];
+  actions[2].op = SPAWN_CLOSE;
+  actions[2].fd = p[1];
+  pid = spawn ("child-simple", actions, 3);
+  close (p[1]);
+  msg ("wait(spawn()) = %d with stdout in a pipe", wait (pid));
+
+  n = read (p[0], buf, sizeof buf - 1);
+  buf[n < 0 ? 0 : n] = '\0';
+  if (strcmp (buf, "(child-simple) run\n"))
+    fail ("read \"%s\" from the pipe", buf);
+  msg ("child wrote into the pipe");
+
+  CHECK (spawn ("no-such-file", NULL, 0) == PID_ERROR,
+         "spawn \"no-such-file\"");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn) begin
+(child-simple) run
+child-simple: exit(81)
+(spawn) wait(spawn()) = 81
+(spawn) pipe
+child-simple: exit(81)
+(spawn) wait(spawn()) = 81 with stdout in a pipe
+(spawn) child wrote into the pipe
+load: no-such-file: open failed
+(spawn) spawn "no-such-file"
+(spawn) end
+spawn: exit(0)
+EOF
+pass;
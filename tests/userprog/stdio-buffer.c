@@ -0,0 +1,28 @@
+/* Builds lines out of several printf(), putchar() and puts()
+   calls, mixes in unbuffered stderr output and explicit
+   flushes, and checks that the console sees each line whole
+   and in order. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  printf ("(%s) ", test_name);
+  printf ("built ");
+  putchar ('u');
+  putchar ('p');
+  puts (" from pieces");
+
+  fprintf (stderr, "(%s) unbuffered stderr\n", test_name);
+
+  printf ("(%s) flushed", test_name);
+  if (fflush (stdout) != 0)
+    fail ("fflush failed");
+  write (STDOUT_FILENO, " by hand\n", 9);
+
+  msg ("back to msg");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stdio-buffer) begin
+(stdio-buffer) built up from pieces
+(stdio-buffer) unbuffered stderr
+(stdio-buffer) flushed by hand
+(stdio-buffer) back to msg
+(stdio-buffer) end
+stdio-buffer: exit(0)
+EOF
+pass;
@@ -0,0 +1,72 @@
+/* Makes some failing and some successful system calls and checks
+   the statistics that the "sysstat" system call reports for
+   them. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns the sum of ST's histogram buckets. */
+static uint64_t
+timed_calls (const struct sysstat *st) 
+{
+  uint64_t sum = 0;
+  int i;
+
+  for (i = 0; i < SYSSTAT_BUCKETS; i++)
+    sum += st->hist[i];
+  return sum;
+}
+
+/* Returns the index of the histogram bucket that counts a
+   latency of CYCLES. */
+static int
+bucket_of (uint64_t cycles) 
+{
+  int bucket = 0;
+
+  while (cycles > 1 && bucket < SYSSTAT_BUCKETS - 1)
+    {
+      cycles >>= 1;
+      bucket++;
+    }
+  return bucket;
+}
+
+void
+test_main (void) 
+{
+  struct sysstat st;
+  int fd, i;
+
+  for (i = 0; i < 3; i++)
+    open ("no-such-file");
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  close (fd);
+
+  CHECK (sysstat (SYS_OPEN, &st), "sysstat (SYS_OPEN)");
+  if (st.calls != 4 || st.errors != 3)
+    fail ("open: %llu calls, %llu errors, expected 4 and 3",
+          st.calls, st.errors);
+  if (timed_calls (&st) != 4)
+    fail ("open: %llu timed calls, expected 4", timed_calls (&st));
+  if (st.max_cycles == 0 || st.max_cycles > st.total_cycles)
+    fail ("open: max %llu cycles out of %llu total",
+          st.max_cycles, st.total_cycles);
+  if (st.hist[bucket_of (st.max_cycles)] == 0)
+    fail ("open: no latency counted in bucket of max %llu cycles",
+          st.max_cycles);
+
+  CHECK (sysstat (SYS_CLOSE, &st), "sysstat (SYS_CLOSE)");
+  if (st.calls != 1 || st.errors != 0)
+    fail ("close: %llu calls, %llu errors, expected 1 and 0",
+          st.calls, st.errors);
+
+  CHECK (sysstat (SYS_MMAP, &st), "sysstat (SYS_MMAP)");
+  if (st.calls != 0 || timed_calls (&st) != 0)
+    fail ("mmap: %llu calls, expected 0", st.calls);
+
+  CHECK (!sysstat (-1, &st), "sysstat (-1) fails");
+  CHECK (!sysstat (SYS_CNT, &st), "sysstat (SYS_CNT) fails");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sysstat) begin
+(sysstat) open "sample.txt"
+(sysstat) sysstat (SYS_OPEN)
+(sysstat) sysstat (SYS_CLOSE)
+(sysstat) sysstat (SYS_MMAP)
+(sysstat) sysstat (-1) fails
+(sysstat) sysstat (SYS_CNT) fails
+(sysstat) end
+sysstat: exit(0)
+EOF
+pass;
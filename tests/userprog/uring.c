@@ -0,0 +1,84 @@
+/* Opens, reads and closes a file through the submission and
+   completion rings, in batches, and checks the completions and
+   the data read. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct uring ring __attribute__ ((aligned (4096)));
+static char buf[sizeof sample];
+static char buf2[20];
+
+/* Queues an operation. */
+static void
+submit (enum uring_op op, int fd, void *addr, unsigned len, int off,
+        uint64_t user_data)
+{
+  struct uring_sqe *sqe = &ring.sqes[ring.sq_tail % URING_SQ_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) addr;
+  sqe->len = len;
+  sqe->off = off;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+/* Takes the next completion, which must be for USER_DATA, and
+   returns its result. */
+static int64_t
+complete (uint64_t user_data)
+{
+  struct uring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for %d", (int) user_data);
+  cqe = &ring.cqes[ring.cq_head % URING_CQ_ENTRIES];
+  if (cqe->user_data != user_data)
+    fail ("completion for %d, expected %d",
+          (int) cqe->user_data, (int) user_data);
+  ring.cq_head++;
+  return cqe->res;
+}
+
+void
+test_main (void) 
+{
+  int fd;
+
+  submit (URING_OP_OPEN, 0, "sample.txt", 0, 0, 1);
+  submit (URING_OP_NOP, 0, NULL, 0, 0, 2);
+  CHECK (uring_enter (&ring, 2) == 2, "open and nop");
+  fd = complete (1);
+  if (fd < 2)
+    fail ("open returned %d", fd);
+  if (complete (2) != 0)
+    fail ("nop failed");
+
+  submit (URING_OP_READ, fd, buf, sizeof buf, 0, 3);
+  submit (URING_OP_PREAD, fd, buf2, sizeof buf2, 10, 4);
+  submit (URING_OP_CLOSE, fd, NULL, 0, 0, 5);
+  CHECK (uring_enter (&ring, 2) == 2, "read and pread");
+  CHECK (uring_enter (&ring, 10) == 1, "close");
+  if (complete (3) != sizeof sample - 1)
+    fail ("read returned wrong count");
+  if (complete (4) != sizeof buf2)
+    fail ("pread returned wrong count");
+  if (complete (5) != 0)
+    fail ("close failed");
+
+  submit (URING_OP_CLOSE, fd, NULL, 0, 0, 6);
+  CHECK (uring_enter (&ring, 1) == 1, "close again");
+  if (complete (6) != -1)
+    fail ("second close succeeded");
+
+  if (memcmp (buf, sample, sizeof sample - 1))
+    fail ("read data differs");
+  if (memcmp (buf2, sample + 10, sizeof buf2))
+    fail ("pread data differs");
+  msg ("data ok");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uring) begin
+(uring) open and nop
+(uring) read and pread
+(uring) close
+(uring) close again
+(uring) data ok
+(uring) end
+uring: exit(0)
+EOF
+pass;
@@ -21,6 +21,7 @@
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/vmalloc.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -86,6 +87,7 @@ main (void) {
 	mem_end = palloc_init ();
 	malloc_init ();
 	paging_init (mem_end);
+	vmalloc_init ();
 
 #ifdef USERPROG
 	tss_init ();
@@ -100,10 +102,12 @@ main (void) {
 #ifdef USERPROG
 	exception_init ();
 	syscall_init ();
+	process_cache_init ();
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start ();
 	serial_init_queue ();
+	console_start_drain ();
 	timer_calibrate ();
 
 #ifdef FILESYS
@@ -152,9 +156,20 @@ paging_init (uint64_t mem_end) {
 	extern char start, _end_kernel_text;
 	// Maps physical address [0 ~ mem_end] to
 	//   [LOADER_KERN_BASE ~ LOADER_KERN_BASE + mem_end].
+	// Whole 2 MB chunks that do not overlap the read-only kernel text
+	// are mapped with a single large page; the rest use 4 kB pages.
 	for (uint64_t pa = 0; pa < mem_end; pa += PGSIZE) {
 		uint64_t va = (uint64_t) ptov(pa);
 
+		if ((pa & LPGMASK) == 0 && pa + LPGSIZE <= mem_end
+				&& (va + LPGSIZE <= (uint64_t) &start
+					|| va >= (uint64_t) &_end_kernel_text)) {
+			if (!pml4_set_large_page (pml4, (void *) va, (void *) va, true))
+				PANIC ("paging_init: out of page table pages");
+			pa += LPGSIZE - PGSIZE;
+			continue;
+		}
+
 		perm = PTE_P | PTE_W;
 		if ((uint64_t) &start <= va && va < (uint64_t) &_end_kernel_text)
 			perm &= ~PTE_W;
@@ -226,6 +241,8 @@ parse_options (char **argv) {
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+		else if (!strcmp (name, "-sc"))
+			syscall_print_stats = true;
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -328,6 +345,7 @@ usage (void) {
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+			"  -sc                Print system call statistics at process exit.\n"
 #endif
 			);
 	power_off ();
@@ -345,6 +363,7 @@ power_off (void) {
 	print_stats ();
 
 	printf ("Powering off...\n");
+	console_flush ();
 	outw (0x604, 0x2000);               /* Poweroff command for qemu */
 	for (;;);
 }
@@ -354,10 +373,13 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	palloc_print_stats ();
+	malloc_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
 	console_print_stats ();
+	serial_print_stats ();
 	kbd_print_stats ();
 #ifdef USERPROG
 	exception_print_stats ();
@@ -40,6 +40,8 @@ struct desc {
 	size_t blocks_per_arena;    /* Number of blocks in an arena. */
 	struct list free_list;      /* List of free blocks. */
 	struct lock lock;           /* Lock. */
+	size_t arena_cnt;           /* Number of arenas owned. */
+	size_t block_cnt;           /* Number of blocks handed out. */
 };
 
 /* Magic number for detecting arena corruption. */
@@ -58,9 +60,14 @@ struct block {
 };
 
 /* Our set of descriptors. */
-static struct desc descs[10];   /* Descriptors. */
+static struct desc descs[MEMSTAT_DESC_CNT];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+/* Blocks too big for any descriptor. */
+static struct lock big_lock;    /* Protects the counts below. */
+static size_t big_cnt;          /* Number of big blocks. */
+static size_t big_page_cnt;     /* Pages held by big blocks. */
+
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
 
@@ -77,6 +84,7 @@ malloc_init (void) {
 		list_init (&d->free_list);
 		lock_init (&d->lock);
 	}
+	lock_init (&big_lock);
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
@@ -109,6 +117,11 @@ malloc (size_t size) {
 		a->magic = ARENA_MAGIC;
 		a->desc = NULL;
 		a->free_cnt = page_cnt;
+
+		lock_acquire (&big_lock);
+		big_cnt++;
+		big_page_cnt += page_cnt;
+		lock_release (&big_lock);
 		return a + 1;
 	}
 
@@ -133,12 +146,14 @@ malloc (size_t size) {
 			struct block *b = arena_to_block (a, i);
 			list_push_back (&d->free_list, &b->free_elem);
 		}
+		d->arena_cnt++;
 	}
 
 	/* Get a block from free list and return it. */
 	b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
 	a = block_to_arena (b);
 	a->free_cnt--;
+	d->block_cnt++;
 	lock_release (&d->lock);
 	return b;
 }
@@ -217,6 +232,7 @@ free (void *p) {
 
 			/* Add block to free list. */
 			list_push_front (&d->free_list, &b->free_elem);
+			d->block_cnt--;
 
 			/* If the arena is now entirely unused, free it. */
 			if (++a->free_cnt >= d->blocks_per_arena) {
@@ -228,17 +244,67 @@ free (void *p) {
 					list_remove (&b->free_elem);
 				}
 				palloc_free_page (a);
+				d->arena_cnt--;
 			}
 
 			lock_release (&d->lock);
 		} else {
 			/* It's a big block.  Free its pages. */
+			lock_acquire (&big_lock);
+			big_cnt--;
+			big_page_cnt -= a->free_cnt;
+			lock_release (&big_lock);
+
 			palloc_free_multiple (a, a->free_cnt);
 			return;
 		}
 	}
 }
 
+/* Fills in the malloc() part of MS.  The waste of a descriptor is
+   every byte of its arenas that is not inside a handed-out block:
+   arena headers, tail slack, and free blocks. */
+void
+malloc_memstat (struct memstat *ms) {
+	size_t i;
+
+	ms->desc_cnt = desc_cnt;
+	for (i = 0; i < desc_cnt; i++) {
+		struct desc *d = &descs[i];
+		struct memstat_desc *md = &ms->descs[i];
+
+		lock_acquire (&d->lock);
+		md->block_size = d->block_size;
+		md->arenas = d->arena_cnt;
+		md->blocks = d->block_cnt;
+		md->waste = d->arena_cnt * PGSIZE - d->block_cnt * d->block_size;
+		lock_release (&d->lock);
+	}
+
+	lock_acquire (&big_lock);
+	ms->big_blocks = big_cnt;
+	ms->big_pages = big_page_cnt;
+	lock_release (&big_lock);
+}
+
+/* Prints malloc() statistics, one line per descriptor in use. */
+void
+malloc_print_stats (void) {
+	struct memstat ms;
+	size_t i;
+
+	malloc_memstat (&ms);
+	for (i = 0; i < ms.desc_cnt; i++) {
+		struct memstat_desc *md = &ms.descs[i];
+		if (md->arenas > 0)
+			printf ("Malloc: %4zu-byte blocks: %zu arenas, %zu blocks, "
+					"%zu bytes wasted\n",
+					md->block_size, md->arenas, md->blocks, md->waste);
+	}
+	printf ("Malloc: %zu big blocks in %zu pages\n",
+			ms.big_blocks, ms.big_pages);
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b) {
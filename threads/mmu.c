@@ -22,7 +22,9 @@ pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 					return NULL;
 			} else
 				return NULL;
-		}
+		} else if (pdp[idx] & PTE_PS)
+			/* VA lies in a large page; its PDE is the leaf entry. */
+			return &pdp[idx];
 		return (uint64_t *) ptov (PTE_ADDR (pdp[idx]) + 8 * PTX (va));
 	}
 	return NULL;
@@ -88,6 +90,41 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	return pte;
 }
 
+/* Returns the address of the page directory entry for virtual
+ * address VA in page map level 4, pml4, creating the intermediate
+ * tables if CREATE is true.  Returns a null pointer if they are
+ * missing and CREATE is false, or if memory allocation fails. */
+static uint64_t *
+pde_walk (uint64_t *pml4, const uint64_t va, int create) {
+	uint64_t *pdpe, *pde = NULL;
+	int allocated = 0;
+
+	if (!(pml4[PML4 (va)] & PTE_P)) {
+		uint64_t *new_page;
+		if (!create || (new_page = palloc_get_page (PAL_ZERO)) == NULL)
+			return NULL;
+		pml4[PML4 (va)] = vtop (new_page) | PTE_U | PTE_W | PTE_P;
+		allocated = 1;
+	}
+	pdpe = ptov (PTE_ADDR (pml4[PML4 (va)]));
+
+	if (pdpe[PDPE (va)] & PTE_P)
+		pde = (uint64_t *) ptov (PTE_ADDR (pdpe[PDPE (va)])) + PDX (va);
+	else if (create) {
+		uint64_t *new_page = palloc_get_page (PAL_ZERO);
+		if (new_page) {
+			pdpe[PDPE (va)] = vtop (new_page) | PTE_U | PTE_W | PTE_P;
+			pde = new_page + PDX (va);
+		}
+	}
+
+	if (pde == NULL && allocated) {
+		palloc_free_page (pdpe);
+		pml4[PML4 (va)] = 0;
+	}
+	return pde;
+}
+
 /* Creates a new page map level 4 (pml4) has mappings for kernel
  * virtual addresses, but none for user virtual addresses.
  * Returns the new page directory, or a null pointer if memory
@@ -122,10 +159,18 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
-			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
-					pml4_index, pdp_index, i))
+		if (!(((uint64_t) pte) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS) {
+			/* A large page is handed to FUNC as a single entry. */
+			void *va = (void *) (((uint64_t) pml4_index << PML4SHIFT) |
+								 ((uint64_t) pdp_index << PDPESHIFT) |
+								 ((uint64_t) i << PDXSHIFT));
+			if (!func (&pdp[i], va, aux))
 				return false;
+		} else if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
+					pml4_index, pdp_index, i))
+			return false;
 	}
 	return true;
 }
@@ -143,7 +188,8 @@ pdp_for_each (uint64_t *pdp,
 	return true;
 }
 
-/* Apply FUNC to each available pte entries including kernel's. */
+/* Apply FUNC to each available pte entries including kernel's.
+ * For a large page FUNC receives its PDE, which has PTE_PS set. */
 bool
 pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
@@ -169,7 +215,11 @@ static void
 pgdir_destroy (uint64_t *pdp) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		if (!(((uint64_t) pte) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS)
+			palloc_free_multiple ((void *) LPTE_ADDR (pte), LPGSIZE / PGSIZE);
+		else
 			pt_destroy (PTE_ADDR (pte));
 	}
 	palloc_free_page ((void *) pdp);
@@ -199,6 +249,43 @@ pml4_destroy (uint64_t *pml4) {
 	palloc_free_page ((void *) pml4);
 }
 
+/* Counts the pages of the user part of PML4, the same part that
+ * pml4_destroy() frees.  Stores the number of resident user pages
+ * in *RSS and the number of page table pages, PML4 included, in
+ * *PT_PAGES. */
+void
+pml4_count_pages (uint64_t *pml4, size_t *rss, size_t *pt_pages) {
+	*rss = 0;
+	*pt_pages = 0;
+	if (pml4 == NULL)
+		return;
+	*pt_pages = 1;
+
+	if (!(pml4[0] & PTE_P))
+		return;
+	uint64_t *pdpe = ptov (PTE_ADDR (pml4[0]));
+	(*pt_pages)++;
+	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
+		if (!(pdpe[i] & PTE_P))
+			continue;
+		uint64_t *pd = ptov (PTE_ADDR (pdpe[i]));
+		(*pt_pages)++;
+		for (unsigned j = 0; j < PGSIZE / sizeof(uint64_t *); j++) {
+			if (!(pd[j] & PTE_P))
+				continue;
+			if (pd[j] & PTE_PS) {
+				*rss += LPGSIZE / PGSIZE;
+				continue;
+			}
+			uint64_t *pt = ptov (PTE_ADDR (pd[j]));
+			(*pt_pages)++;
+			for (unsigned k = 0; k < PGSIZE / sizeof(uint64_t *); k++)
+				if (pt[k] & PTE_P)
+					(*rss)++;
+		}
+	}
+}
+
 /* Loads page directory PD into the CPU's page directory base
  * register. */
 void
@@ -216,11 +303,40 @@ pml4_get_page (uint64_t *pml4, const void *uaddr) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
 
-	if (pte && (*pte & PTE_P))
+	if (pte && (*pte & PTE_P)) {
+		if (*pte & PTE_PS)
+			return ptov (LPTE_ADDR (*pte)) + ((uint64_t) uaddr & LPGMASK);
 		return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
+	}
 	return NULL;
 }
 
+/* Like pml4_get_page(), but for the kernel to access UADDR's frame
+ * on a user process's behalf through the returned address.  Returns
+ * a null pointer unless UADDR is mapped user-accessible, and, if
+ * WRITE is true, writable.  Accesses through the kernel mapping do
+ * not touch UADDR's PTE, so this marks it accessed, and dirty if
+ * WRITE is true, up front.  A copy-on-write page gets its private
+ * copy first if WRITE is true. */
+void *
+pml4_get_user_page (uint64_t *pml4, const void *uaddr, bool write) {
+	ASSERT (is_user_vaddr (uaddr));
+
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
+
+	if (pte == NULL || (*pte & (PTE_P | PTE_U)) != (PTE_P | PTE_U))
+		return NULL;
+	if (write && (*pte & PTE_COW) && !pml4_break_cow (pml4, uaddr))
+		return NULL;
+	if (write && !is_writable (pte))
+		return NULL;
+
+	*pte |= PTE_A | (write ? PTE_D : 0);
+	if (*pte & PTE_PS)
+		return ptov (LPTE_ADDR (*pte)) + ((uint64_t) uaddr & LPGMASK);
+	return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
+}
+
 /* Adds a mapping in page map level 4 PML4 from user virtual page
  * UPAGE to the physical frame identified by kernel virtual address KPAGE.
  * UPAGE must not already be mapped. KPAGE should probably be a page obtained
@@ -238,11 +354,141 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);
 
+	if (pte && (*pte & PTE_PS))
+		return false;
 	if (pte)
 		*pte = vtop (kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
 	return pte != NULL;
 }
 
+/* Maps user virtual page UPAGE in page map level 4 DST to the
+ * same frame as SRC_PTE, UPAGE's present 4 kB user PTE in page map
+ * level 4 SRC, taking a reference to the frame.  If SRC_PTE is
+ * writable, both mappings become read-only copy-on-write, so that
+ * the first write through either gets a private copy from
+ * pml4_break_cow().  Returns true if successful, false if memory
+ * allocation failed. */
+bool
+pml4_share_page (uint64_t *dst, void *upage, uint64_t *src,
+		uint64_t *src_pte) {
+	ASSERT (pg_ofs (upage) == 0);
+	ASSERT (is_user_vaddr (upage));
+	ASSERT ((*src_pte & (PTE_P | PTE_U | PTE_PS)) == (PTE_P | PTE_U));
+
+	uint64_t *pte = pml4e_walk (dst, (uint64_t) upage, 1);
+
+	if (pte == NULL)
+		return false;
+	if (*src_pte & PTE_W) {
+		*src_pte = (*src_pte & ~PTE_W) | PTE_COW;
+
+		/* A stale writable TLB entry would let SRC write to the
+		 * shared frame.  If SRC is not active, loading it again
+		 * in schedule()'s process_activate() flushes the TLB. */
+		if (rcr3 () == vtop (src))
+			invlpg ((uint64_t) upage);
+	}
+	*pte = *src_pte & ~(PTE_A | PTE_D);
+	palloc_ref_page (ptov (PTE_ADDR (*src_pte)));
+	return true;
+}
+
+/* Gives copy-on-write user page UADDR in PML4 back write access,
+ * copying its frame first if another page table still shares it.
+ * Returns false if UADDR is not mapped copy-on-write or no frame
+ * is left for the copy. */
+bool
+pml4_break_cow (uint64_t *pml4, const void *uaddr) {
+	ASSERT (is_user_vaddr (uaddr));
+
+	uint64_t *pte = pml4 != NULL ? pml4e_walk (pml4, (uint64_t) uaddr, 0) : NULL;
+	void *kpage;
+
+	if (pte == NULL || (*pte & (PTE_P | PTE_COW)) != (PTE_P | PTE_COW))
+		return false;
+
+	kpage = ptov (PTE_ADDR (*pte));
+	if (palloc_page_refs (kpage) > 1) {
+		void *copy = palloc_get_page (PAL_USER);
+
+		if (copy == NULL)
+			return false;
+		memcpy (copy, kpage, PGSIZE);
+		*pte = vtop (copy) | (*pte & PTE_FLAGS);
+		palloc_free_page (kpage);
+	}
+	*pte = (*pte | PTE_W) & ~PTE_COW;
+	if (rcr3 () == vtop (pml4))
+		invlpg ((uint64_t) pg_round_down (uaddr));
+	return true;
+}
+
+/* Adds a 2 MB mapping in page map level 4 PML4 from virtual address
+ * VA to the physically contiguous frames starting at kernel virtual
+ * address KPAGE.  VA and the physical address of KPAGE must both be
+ * aligned to LPGSIZE, and no page may already be mapped in the range.
+ * A user VA gets a user-accessible mapping; KPAGE should then be
+ * LPGSIZE / PGSIZE pages obtained from the user pool with
+ * palloc_get_multiple(), which pml4_destroy() frees as one unit.
+ * If RW is true, the new page is read/write; otherwise it is
+ * read-only.
+ * Returns true if successful, false if memory allocation failed or
+ * the range is already mapped. */
+bool
+pml4_set_large_page (uint64_t *pml4, void *va, void *kpage, bool rw) {
+	ASSERT (((uint64_t) va & LPGMASK) == 0);
+	ASSERT ((vtop (kpage) & LPGMASK) == 0);
+	ASSERT (is_kernel_vaddr (va) || pml4 != base_pml4);
+
+	uint64_t *pde = pde_walk (pml4, (uint64_t) va, 1);
+
+	if (pde == NULL || (*pde & PTE_P))
+		return false;
+	*pde = vtop (kpage) | PTE_P | PTE_PS | (rw ? PTE_W : 0)
+		| (is_user_vaddr (va) ? PTE_U : 0);
+	return true;
+}
+
+/* Adds a kernel-only, read/write mapping in PML4 from kernel
+ * virtual page VPAGE to the frame identified by kernel virtual
+ * address KPAGE.  VPAGE must lie outside the direct map and must
+ * not already be mapped.  Page tables created here under the
+ * kernel's PML4 entry are shared by every pml4 made with
+ * pml4_create(), so the mapping is visible in all of them.
+ * Returns true if successful, false if memory allocation
+ * failed. */
+bool
+pml4_set_kernel_page (uint64_t *pml4, void *vpage, void *kpage) {
+	ASSERT (pg_ofs (vpage) == 0);
+	ASSERT (pg_ofs (kpage) == 0);
+	ASSERT (is_kernel_vaddr (vpage));
+
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, 1);
+
+	if (pte == NULL)
+		return false;
+	ASSERT (!(*pte & PTE_P));
+	*pte = vtop (kpage) | PTE_P | PTE_W;
+	return true;
+}
+
+/* Removes the mapping of kernel virtual page VPAGE from PML4,
+ * added by pml4_set_kernel_page(), and returns the kernel virtual
+ * address of the frame it mapped. */
+void *
+pml4_clear_kernel_page (uint64_t *pml4, void *vpage) {
+	ASSERT (pg_ofs (vpage) == 0);
+	ASSERT (is_kernel_vaddr (vpage));
+
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, 0);
+
+	ASSERT (pte != NULL && (*pte & PTE_P) && !(*pte & PTE_PS));
+	void *kpage = ptov (PTE_ADDR (*pte));
+	*pte = 0;
+	invlpg ((uint64_t) vpage);
+	return kpage;
+}
+
 /* Marks user virtual page UPAGE "not present" in page
  * directory PD.  Later accesses to the page will fault.  Other
  * bits in the page table entry are preserved.
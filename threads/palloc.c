@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -24,13 +25,29 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   The split is not rigid, though.  When one pool runs dry, the
+   request is satisfied from the other pool as long as that pool
+   keeps at least a low watermark of free pages for its own use.
+   A borrowed page is still tracked by the pool it came from, so
+   freeing it hands it back there.  This way either side grows
+   into the other's idle memory and shrinks again as it frees.
+   Users cannot borrow when the user pool was limited with -ul. */
+
+/* Free pages a pool keeps for itself before lending to the other
+   pool: 1/LEND_WATERMARK_DIV of its usable pages. */
+#define LEND_WATERMARK_DIV 8
 
 /* A memory pool. */
 struct pool {
 	struct lock lock;               /* Mutual exclusion. */
 	struct bitmap *used_map;        /* Bitmap of free pages. */
 	uint8_t *base;                  /* Base of pool. */
+	size_t page_cnt;                /* Number of usable pages. */
+	size_t free_cnt;                /* Number of free pages. */
+	size_t lent_cnt;                /* Pages ever lent to the other pool. */
+	uint16_t *refs;                 /* References to each page. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -38,10 +55,18 @@ static struct pool kernel_pool, user_pool;
 
 /* Maximum number of pages to put in user pool. */
 size_t user_page_limit = SIZE_MAX;
+
+/* Called to free reclaimable pages when a pool runs dry. */
+static palloc_reclaim_func *reclaim_func;
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
+static void *pool_get_multiple (struct pool *, size_t page_cnt, bool lend);
 static bool page_from_pool (const struct pool *, void *page);
+static void pool_adjust_free (struct pool *, int64_t delta);
+static void *get_pages (enum palloc_flags, size_t page_cnt);
+static struct pool *pool_of_page (void *page);
+static bool pool_put_pages (struct pool *, size_t page_idx, size_t page_cnt);
 
 /* multiboot info */
 struct multiboot_info {
@@ -232,6 +257,11 @@ split:
 			}
 		}
 	}
+
+	kernel_pool.page_cnt = kernel_pool.free_cnt = bitmap_count (
+			kernel_pool.used_map, 0, bitmap_size (kernel_pool.used_map), false);
+	user_pool.page_cnt = user_pool.free_cnt = bitmap_count (
+			user_pool.used_map, 0, bitmap_size (user_pool.used_map), false);
 }
 
 /* Initializes the page allocator and get the memory size */
@@ -255,23 +285,23 @@ palloc_init (void) {
 
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
    If PAL_USER is set, the pages are obtained from the user pool,
-   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
-   then the pages are filled with zeros.  If too few pages are
-   available, returns a null pointer, unless PAL_ASSERT is set in
-   FLAGS, in which case the kernel panics. */
+   otherwise from the kernel pool.  If that pool is short of pages,
+   they are borrowed from the other pool if it is above its
+   watermark.  If both are dry, the reclaim function set with
+   palloc_set_reclaim() gets a chance to free some pages.  If
+   PAL_ZERO is set in FLAGS, then the pages are filled with
+   zeros.  If too few pages are available, returns a null
+   pointer, unless PAL_ASSERT is set in FLAGS, in which case the
+   kernel panics. */
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
-	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
-
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
-	void *pages;
+	void *pages = get_pages (flags, page_cnt);
 
-	if (page_idx != BITMAP_ERROR)
-		pages = pool->base + PGSIZE * page_idx;
-	else
-		pages = NULL;
+	/* Out of pages: have caches give back what they can, and try
+	   once more. */
+	if (pages == NULL && reclaim_func != NULL && !intr_context ()
+			&& reclaim_func () > 0)
+		pages = get_pages (flags, page_cnt);
 
 	if (pages) {
 		if (flags & PAL_ZERO)
@@ -296,7 +326,9 @@ palloc_get_page (enum palloc_flags flags) {
 	return palloc_get_multiple (flags, 1);
 }
 
-/* Frees the PAGE_CNT pages starting at PAGES. */
+/* Frees the PAGE_CNT pages starting at PAGES.  A page shared
+   with palloc_ref_page() is only freed once every reference to
+   it has been dropped. */
 void
 palloc_free_multiple (void *pages, size_t page_cnt) {
 	struct pool *pool;
@@ -306,20 +338,17 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 	if (pages == NULL || page_cnt == 0)
 		return;
 
-	if (page_from_pool (&kernel_pool, pages))
-		pool = &kernel_pool;
-	else if (page_from_pool (&user_pool, pages))
-		pool = &user_pool;
-	else
-		NOT_REACHED ();
-
+	pool = pool_of_page (pages);
 	page_idx = pg_no (pages) - pg_no (pool->base);
+	if (!pool_put_pages (pool, page_idx, page_cnt))
+		return;
 
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	pool_adjust_free (pool, page_cnt);
 }
 
 /* Frees the page at PAGE. */
@@ -328,23 +357,167 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Adds a reference to PAGE, a single page in use, so that it
+   takes one more palloc_free_page() to free it.  Used to share
+   user frames between processes. */
+void
+palloc_ref_page (void *page) {
+	struct pool *pool = pool_of_page (page);
+	size_t page_idx = pg_no (page) - pg_no (pool->base);
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (pool->refs[page_idx] > 0 && pool->refs[page_idx] < UINT16_MAX);
+	pool->refs[page_idx]++;
+	intr_set_level (old_level);
+}
+
+/* Returns the number of references to PAGE, a page in use. */
+size_t
+palloc_page_refs (void *page) {
+	struct pool *pool = pool_of_page (page);
+
+	return pool->refs[pg_no (page) - pg_no (pool->base)];
+}
+
+/* Makes palloc_get_multiple() call FUNC to free pages that can be
+   rebuilt, such as cached file pages, before it gives up.  FUNC
+   runs in the allocating thread, possibly with locks held, so it
+   must not wait for locks or allocate memory. */
+void
+palloc_set_reclaim (palloc_reclaim_func *func) {
+	reclaim_func = func;
+}
+
+/* Fills in the page allocator part of MS. */
+void
+palloc_memstat (struct memstat *ms) {
+	enum intr_level old_level = intr_disable ();
+	ms->kern_free = kernel_pool.free_cnt;
+	ms->kern_used = kernel_pool.page_cnt - kernel_pool.free_cnt;
+	ms->user_free = user_pool.free_cnt;
+	ms->user_used = user_pool.page_cnt - user_pool.free_cnt;
+	intr_set_level (old_level);
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	struct memstat ms;
+
+	palloc_memstat (&ms);
+	printf ("Palloc: kernel pool %zu/%zu pages used, "
+			"user pool %zu/%zu pages used\n",
+			ms.kern_used, ms.kern_used + ms.kern_free,
+			ms.user_used, ms.user_used + ms.user_free);
+	printf ("Palloc: lent %zu kernel pages to users, "
+			"%zu user pages to the kernel\n",
+			kernel_pool.lent_cnt, user_pool.lent_cnt);
+}
+
+/* Takes PAGE_CNT contiguous free pages from POOL.  If LEND is true
+   the pages go to the other pool's caller, so POOL only gives them
+   up while it stays above its watermark.  Returns a null pointer
+   if the pages are not available. */
+static void *
+pool_get_multiple (struct pool *pool, size_t page_cnt, bool lend) {
+	size_t reserve = lend ? pool->page_cnt / LEND_WATERMARK_DIV : 0;
+	size_t page_idx = BITMAP_ERROR;
+
+	lock_acquire (&pool->lock);
+	if (pool->free_cnt >= page_cnt + reserve)
+		page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+	if (page_idx != BITMAP_ERROR) {
+		size_t i;
+
+		for (i = 0; i < page_cnt; i++)
+			pool->refs[page_idx + i] = 1;
+		pool_adjust_free (pool, -(int64_t) page_cnt);
+		if (lend)
+			pool->lent_cnt += page_cnt;
+	}
+	lock_release (&pool->lock);
+
+	if (page_idx == BITMAP_ERROR)
+		return NULL;
+	return pool->base + PGSIZE * page_idx;
+}
+
+/* Adds DELTA to the free page count of POOL.  Pages are freed
+   without holding the pool lock, so the count is updated with
+   interrupts off instead. */
+static void
+pool_adjust_free (struct pool *pool, int64_t delta) {
+	enum intr_level old_level = intr_disable ();
+	pool->free_cnt += delta;
+	intr_set_level (old_level);
+}
+
+/* Takes PAGE_CNT pages from the pool that FLAGS selects, or
+   borrows them from the other pool, for palloc_get_multiple(). */
+static void *
+get_pages (enum palloc_flags flags, size_t page_cnt) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	struct pool *lender = flags & PAL_USER ? &kernel_pool : &user_pool;
+	void *pages;
+
+	pages = pool_get_multiple (pool, page_cnt, false);
+	if (pages == NULL && !(flags & PAL_USER && user_page_limit != SIZE_MAX))
+		pages = pool_get_multiple (lender, page_cnt, true);
+	return pages;
+}
+
+/* Drops a reference to each of the PAGE_CNT pages at PAGE_IDX in
+   POOL.  Returns true if those were the last references, in which
+   case the caller frees the pages.  Only single pages are ever
+   shared. */
+static bool
+pool_put_pages (struct pool *pool, size_t page_idx, size_t page_cnt) {
+	enum intr_level old_level = intr_disable ();
+	bool last = true;
+	size_t i;
+
+	if (page_cnt == 1 && pool->refs[page_idx] > 1) {
+		pool->refs[page_idx]--;
+		last = false;
+	} else
+		for (i = 0; i < page_cnt; i++) {
+			ASSERT (pool->refs[page_idx + i] == 1);
+			pool->refs[page_idx + i] = 0;
+		}
+	intr_set_level (old_level);
+	return last;
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's used_map, followed by its reference
+     counts, at its base.  Calculate the space needed for them
      and subtract it from the pool's size. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
 	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
+	size_t ref_pages = DIV_ROUND_UP (pgcnt * sizeof *p->refs, PGSIZE) * PGSIZE;
 
 	lock_init(&p->lock);
 	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
 	p->base = (void *) start;
+	p->refs = *bm_base + bm_pages;
+	memset (p->refs, 0, ref_pages);
 
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
 
-	*bm_base += bm_pages;
+	*bm_base += bm_pages + ref_pages;
+}
+
+/* Returns the pool that PAGE belongs to. */
+static struct pool *
+pool_of_page (void *page) {
+	if (page_from_pool (&kernel_pool, page))
+		return &kernel_pool;
+	else if (page_from_pool (&user_pool, page))
+		return &user_pool;
+	NOT_REACHED ();
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -16,6 +16,7 @@
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "threads/malloc.h"
+#include "userprog/pipe.h"
 #endif
 
 /* Random value for struct thread's `magic' member.
@@ -41,6 +42,17 @@ static int load_avg; // in 17.14 format
    that are ready to run but not actually running. */
 static struct list ready_list;
 static struct list sleep_list; // P1-AC
+
+// P2
+// poll에서 이벤트를 기다리는 쓰레드
+struct poll_waiter {
+	struct list_elem elem; // poll_list에 사용되는 elem
+	struct thread *t;
+	bool queued; // poll_list에 들어있는지
+	bool timed; // sleep_list에도 들어있는지
+};
+static struct list poll_list; // 이벤트를 기다리는 poll_waiter의 리스트
+static uint64_t poll_seq; // thread_poll_wake()가 호출된 횟수
 static struct list all_list; // P1-AS
 
 /* Idle thread. */
@@ -143,6 +155,7 @@ thread_init (void) {
 	initial_thread->tid = allocate_tid ();
 
 	list_init(&sleep_list); // P1-AC
+	list_init(&poll_list); // P2
 	// P1-AS
 	list_init(&all_list); // P2에서 all_list를 사용
 	list_push_back(&all_list, &initial_thread->elem_2);
@@ -226,26 +239,46 @@ thread_print_stats (void) {
 }
 
 // P2
-// 쓰레드 구조체 내의 file_list를 초기화하고 stdin, stdout을 추가
-static void init_file_list(struct thread *t) {
-	struct list *file_list = &t->file_list;
-	list_init(file_list);
-	
-	struct file_elem *stdin_fe = malloc(sizeof(*stdin_fe));
-	// struct file_elem *stdin_fe = palloc_get_page(PAL_USER);
-	stdin_fe->fd = 0;
-	stdin_fe->file = NULL;
-	stdin_fe->std_no = STDIN_FILENO;
-	// list_insert_ordered(&file_list, &stdin_fe.elem, file_elem_fd_less, NULL);
-	list_push_back(file_list, &stdin_fe->elem);
-
-	struct file_elem *stdout_fe = malloc(sizeof(*stdout_fe));
-	// struct file_elem *stdout_fe = palloc_get_page(PAL_USER);
-	stdout_fe->fd = 1;
-	stdout_fe->file = NULL;
-	stdout_fe->std_no = STDOUT_FILENO;
-	// list_insert_ordered(&file_list, &stdout_fe.elem, file_elem_fd_less, NULL);
-	list_push_back(file_list, &stdout_fe->elem);
+// std_no에 해당하는 stdin/stdout file_elem을 fd에 등록
+static void add_std_fe(struct fd_table *ft, int fd, int std_no) {
+	struct file_elem *fe = malloc(sizeof(*fe));
+	if (fe == NULL) {
+		return;
+	}
+	fe->file = NULL;
+	fe->std_no = std_no;
+	fe->pipe = NULL;
+	fe->writer = false;
+	fe->ref_cnt = 1;
+	ft->fes[fd] = fe;
+	ft->used[fd / 64] |= 1ULL << (fd % 64);
+}
+
+// 쓰레드 구조체 내의 fd_table을 size 칸으로 초기화
+// 메모리가 부족하면 빈 table로 남기고 false 반환
+static bool init_fd_table(struct fd_table *ft, int size) {
+	ft->fes = calloc(size, sizeof(*ft->fes));
+	ft->used = calloc(size / 64, sizeof(*ft->used));
+	if (ft->fes == NULL || ft->used == NULL) {
+		free(ft->fes);
+		free(ft->used);
+		ft->fes = NULL;
+		ft->used = NULL;
+		ft->size = 0;
+		return false;
+	}
+	ft->size = size;
+	return true;
+}
+
+// fd_table을 초기화하고 stdin, stdout을 추가
+static void init_std_fds(struct thread *t) {
+	struct fd_table *ft = &t->fd_table;
+
+	if (init_fd_table(ft, FD_TABLE_MIN)) {
+		add_std_fe(ft, 0, STDIN_FILENO);
+		add_std_fe(ft, 1, STDOUT_FILENO);
+	}
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -299,7 +332,7 @@ thread_create (const char *name, int priority,
 
 	t->p_tid = cur_t->tid; // 부모 쓰레드 tid 저장 (P2)
 
-	init_file_list(t); // fd table로 사용되는 file_list 초기화 (P2)
+	init_std_fds(t); // fd_table 초기화 (P2)
 
 	/* Call the kernel_thread if it scheduled.
 	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
@@ -372,6 +405,63 @@ void thread_sleep_until(int64_t wake_tick) {
 	intr_set_level (old_level);
 }
 
+// P2
+// 현재의 poll 이벤트 번호, thread_poll_wait()에 넘겨 그 사이의 이벤트를 놓치지 않게 함
+uint64_t thread_poll_seq(void) {
+	return poll_seq;
+}
+
+// P2
+// seq를 읽은 뒤로 thread_poll_wake()가 호출되었거나 wake_tick이 될 때까지 block
+// 이미 호출되었다면 바로 반환, wake_tick이 INT64_MAX이면 시간 제한 없음
+void thread_poll_wait(uint64_t seq, int64_t wake_tick) {
+	struct poll_waiter w;
+	w.t = thread_current();
+	w.timed = wake_tick != __INT64_MAX__;
+
+	enum intr_level old_level = intr_disable ();
+
+	if (poll_seq == seq) {
+		w.queued = true;
+		list_push_back(&poll_list, &w.elem);
+		if (w.timed) {
+			w.t->wake_tick = wake_tick;
+			list_insert_ordered(&sleep_list, &w.t->elem, thread_wake_tick_less, NULL);
+		}
+		thread_block();
+
+		if (w.queued) {
+			// 시간이 다 되어 깨어남
+			list_remove(&w.elem);
+		}
+	}
+
+	intr_set_level (old_level);
+}
+
+// P2
+// poll 중인 쓰레드를 모두 깨움, 깨어난 쓰레드는 직접 준비 상태를 다시 확인
+// 인터럽트 핸들러에서도 호출 가능
+void thread_poll_wake(void) {
+	enum intr_level old_level = intr_disable ();
+
+	poll_seq++;
+	while (!list_empty(&poll_list)) {
+		struct poll_waiter *w = list_entry(list_pop_front(&poll_list),
+										   struct poll_waiter, elem);
+		w->queued = false;
+		// 시간이 다 되어 이미 깨어난 쓰레드는 건드리지 않음
+		if (w->t->status == THREAD_BLOCKED) {
+			if (w->timed) {
+				list_remove(&w->t->elem);
+			}
+			thread_unblock(w->t);
+		}
+	}
+
+	intr_set_level (old_level);
+}
+
 // P1-AC
 // sleep_list 리스트에서 깨울 시간이 지난 쓰레드들을 unblock
 int64_t thread_wake_sleepers(int64_t cur_tick) {
@@ -695,111 +785,197 @@ struct thread *thread_get_by_id(tid_t tid) {
 }
 
 // P2
-// fork 호출 시 file_list를 복사, 실패 시 -1 반환
-// int syscall_dup_file_list(struct thread *old_t, struct thread *new_t) {
-bool thread_dup_file_list(struct thread *old_t, struct thread *new_t) {
-	struct list *old_l = &old_t->file_list;
-	struct list *new_l = &new_t->file_list;
+// fd_table이 fd를 담을 수 있도록 배열과 비트맵을 두 배씩 늘림, 실패 시 false 반환
+static bool grow_fd_table(struct fd_table *ft, int fd) {
+	struct fd_table new_ft;
+	int size = ft->size > 0 ? ft->size : FD_TABLE_MIN;
 
-	list_init(new_l);
+	if (fd < ft->size) {
+		return true;
+	}
+	if (fd >= FD_MAX) {
+		return false;
+	}
 
-	struct list_elem *e;
-	struct file_elem *fe;
-	struct file_elem *clone_fe;
+	while (size <= fd) {
+		size *= 2;
+	}
+	if (!init_fd_table(&new_ft, size)) {
+		return false;
+	}
+	if (ft->size > 0) {
+		memcpy(new_ft.fes, ft->fes, ft->size * sizeof(*ft->fes));
+		memcpy(new_ft.used, ft->used, ft->size / 64 * sizeof(*ft->used));
+	}
+	free(ft->fes);
+	free(ft->used);
+	*ft = new_ft;
+	return true;
+}
 
-	for (e = list_begin(old_l); e != list_end(old_l); e = list_next(e)) {
-		fe = list_entry(e, struct file_elem, elem);
+// 현재 쓰레드에서 fd에 해당하는 file_elem을 반환, 없으면 NULL
+struct file_elem *thread_get_fe(int fd) {
+	struct fd_table *ft = &thread_current()->fd_table;
 
-		clone_fe = malloc(sizeof(*clone_fe));
-		if (clone_fe == NULL) {
-			return false;
-		}
-		clone_fe->fd = fe->fd;
-		clone_fe->std_no = fe->std_no;
-		if (fe->file) {
-			clone_fe->file = file_duplicate(fe->file);
-			if (clone_fe->file == NULL) {
-				return false;
-			}
-		} else {
-			// file이 stdin/stdout이거나 dup 닫기에 의해 삭제된 상태여서 NULL임
-			clone_fe->file = NULL;
+	if (fd < 0 || fd >= ft->size) {
+		return NULL;
+	}
+	return ft->fes[fd];
+}
+
+// fe를 비어있는 가장 작은 fd에 등록하고 fd를 반환, 실패 시 -1 반환
+int thread_add_fe(struct file_elem *fe) {
+	struct fd_table *ft = &thread_current()->fd_table;
+	int i;
+
+	// 비트맵에서 빈 비트가 있는 첫 워드를 찾음
+	for (i = 0; i < ft->size / 64; i++) {
+		if (ft->used[i] != UINT64_MAX) {
+			break;
 		}
+	}
 
-		list_push_back(new_l, &clone_fe->elem);
+	int fd = i * 64 + (i < ft->size / 64 ? __builtin_ctzll(~ft->used[i]) : 0);
+	if (!thread_set_fe(fd, fe)) {
+		return -1;
 	}
+	return fd;
+}
+
+// fd에 fe를 등록, 필요하면 table을 늘림, 실패 시 false 반환
+// fd에 이미 등록된 file_elem은 호출자가 미리 처리해야 함
+bool thread_set_fe(int fd, struct file_elem *fe) {
+	struct fd_table *ft = &thread_current()->fd_table;
 
+	if (fd < 0 || !grow_fd_table(ft, fd)) {
+		return false;
+	}
+	ft->fes[fd] = fe;
+	ft->used[fd / 64] |= 1ULL << (fd % 64);
 	return true;
 }
 
-// P2
-// exit 호출 시 file_list를 모두 삭제
-void thread_clear_file_list(void) {
-	struct list *file_list = &thread_current()->file_list;
-	struct list_elem *e, *e2;
-	struct file_elem *fe, *fe2;
-
-	// for (e = list_begin(file_list); e != list_end(file_list); e = list_remove(e)) {
+// oldfd가 가리키는 file_elem을 newfd에도 등록, 실패 시 false 반환
+// newfd가 이미 존재하면 oldfd를 복사한 뒤 기존 파일을 닫음
+bool thread_dup_fe(int oldfd, int newfd) {
+	struct file_elem *old_fe = thread_get_fe(oldfd);
+	if (old_fe == NULL) {
+		return false;
+	}
+	if (oldfd == newfd) {
+		return true;
+	}
 
-	for (e = list_begin(file_list); e != list_end(file_list); e = list_begin(file_list)) {
-		fe = list_entry(e, struct file_elem, elem);
+	struct file_elem *new_fe = thread_get_fe(newfd);
+	if (!thread_set_fe(newfd, old_fe)) {
+		return false;
+	}
+	old_fe->ref_cnt++;
+	if (new_fe != NULL) {
+		thread_put_fe(new_fe);
+	}
+	return true;
+}
 
-		// file_close(fe->file);
-		// list_remove(&fe->elem);
-		// free(fe);
+// fd의 등록을 해제하고 등록되어 있던 file_elem을 반환, 없으면 NULL
+struct file_elem *thread_remove_fe(int fd) {
+	struct fd_table *ft = &thread_current()->fd_table;
+	struct file_elem *fe = thread_get_fe(fd);
 
-		// e = list_prev(e);
-		// list_remove(e);
+	if (fe != NULL) {
+		ft->fes[fd] = NULL;
+		ft->used[fd / 64] &= ~(1ULL << (fd % 64));
+	}
+	return fe;
+}
 
-		if (fe->file) {
-			// dup된 fd가 있다면, file을 모두 NULL로 변경
-			for (e2 = list_next(e); e2 != list_end(file_list); e2 = list_next(e)) {
-				fe2 = list_entry(e2, struct file_elem, elem);
+// fe를 가리키던 fd 하나가 사라짐, 마지막 fd였다면 파일이나 파이프를 닫고 해제
+void thread_put_fe(struct file_elem *fe) {
+	ASSERT(fe->ref_cnt > 0);
 
-				if (fe->file == fe2->file) {
-					// 복사된 fd 발견
-					fe2->file = NULL;
-				}
-			}
-			file_close(fe->file);
+	if (--fe->ref_cnt == 0) {
+		file_close(fe->file);
+		if (fe->pipe != NULL) {
+			pipe_close(fe->pipe, fe->writer);
 		}
-
-		list_remove(e);
 		free(fe);
+	}
+}
 
-		// close(fe->fd);
-
-
-		// struct file_elem *fe = get_file_in_list(fd);
+// fork 호출 시 fd_table을 복사, 실패 시 false 반환
+// dup2로 file_elem을 공유하던 fd들은 자식에서도 하나의 복사본을 공유
+bool thread_dup_fd_table(struct thread *old_t, struct thread *new_t) {
+	struct fd_table *old_ft = &old_t->fd_table;
+	struct fd_table *new_ft = &new_t->fd_table;
+	struct file_elem *fe;
+	int fd;
 
-		// if (fe == NULL) {
-		// 	// fd에 해당하는 요소가 없음
-		// 	exit(-1);
-		// }
+	// thread_create()에서 만든 기본 table을 버리고 부모와 같은 크기로 새로 만듦
+	thread_clear_fd_table(new_t);
+	if (old_ft->size > 0 && !init_fd_table(new_ft, old_ft->size)) {
+		return false;
+	}
 
-		// // file이 NULL이면 복사된 fd에 의해 이미 닫힌 파일
+	for (fd = 0; fd < old_ft->size; fd++) {
+		if ((fe = old_ft->fes[fd]) != NULL) {
+			fe->clone = NULL;
+		}
+	}
 
-		// if (fe->file != NULL) {
-		// 	// 이미 닫힌 파일이 아닌 경우
-		// 	struct list *file_list = &thread_current()->file_list;
-		// 	struct list_elem *e;
-		// 	struct file_elem *dup_fe;
+	for (fd = 0; fd < old_ft->size; fd++) {
+		if ((fe = old_ft->fes[fd]) == NULL) {
+			continue;
+		}
 
-		// 	// 복사된 fd를 모두 찾아 file을 NULL로 변경
-		// 	for (e = list_begin(file_list); e != list_end(file_list); e = list_next(e)) {
-		// 		dup_fe = list_entry(e, struct file_elem, elem);
-		// 		if (dup_fe->file == fe->file) {
-		// 			dup_fe->file = NULL;
-		// 		}
-		// 	}
-		// }
+		if (fe->clone == NULL) {
+			struct file_elem *clone_fe = malloc(sizeof(*clone_fe));
+			if (clone_fe == NULL) {
+				return false;
+			}
+			clone_fe->std_no = fe->std_no;
+			clone_fe->ref_cnt = 0;
+			clone_fe->file = NULL;
+			clone_fe->pipe = fe->pipe;
+			clone_fe->writer = fe->writer;
+			if (fe->file) {
+				clone_fe->file = file_duplicate(fe->file);
+				if (clone_fe->file == NULL) {
+					free(clone_fe);
+					return false;
+				}
+			}
+			if (fe->pipe != NULL) {
+				// 자식도 같은 파이프의 같은 쪽 끝을 가짐
+				pipe_open(fe->pipe, fe->writer);
+			}
+			fe->clone = clone_fe;
+		}
 
-		// file_close(fe->file);
-		// list_remove(&fe->elem);
-		// free(fe);
+		new_ft->fes[fd] = fe->clone;
+		new_ft->used[fd / 64] |= 1ULL << (fd % 64);
+		fe->clone->ref_cnt++;
+	}
 
+	return true;
+}
 
+// P2
+// exit 호출 시 t의 fd_table에 등록된 모든 파일을 닫고 table 삭제
+void thread_clear_fd_table(struct thread *t) {
+	struct fd_table *ft = &t->fd_table;
+	int fd;
+
+	for (fd = 0; fd < ft->size; fd++) {
+		if (ft->fes[fd] != NULL) {
+			thread_put_fe(ft->fes[fd]);
+		}
 	}
+
+	free(ft->fes);
+	free(ft->used);
+	ft->fes = NULL;
+	ft->used = NULL;
+	ft->size = 0;
 }
 
 // P2
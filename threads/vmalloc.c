@@ -0,0 +1,146 @@
+#include "threads/vmalloc.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+
+/* Allocator for large kernel buffers that need not be physically
+   contiguous.
+
+   malloc() hands out blocks bigger than 2 kB, and
+   palloc_get_multiple() hands out runs of pages, only when that
+   many physically contiguous free pages exist.  Once the pools
+   fragment, big requests fail even though plenty of single pages
+   are free.  vmalloc() instead takes each page separately from the
+   page allocator and maps them back to back in a window of kernel
+   virtual addresses reserved for this purpose.
+
+   Like a big block in malloc(), an allocation starts with a small
+   header recording its page count, which vfree() reads back.
+
+   Memory from vmalloc() is only virtually contiguous, so it must
+   never be passed to vtop(), palloc_free_page() or free(). */
+
+/* Magic number for detecting header corruption. */
+#define VMALLOC_MAGIC 0x5f3a91c7
+
+/* Start of every vmalloc() allocation. */
+struct vm_header {
+	unsigned magic;             /* Always set to VMALLOC_MAGIC. */
+	size_t page_cnt;            /* Pages in the allocation. */
+};
+
+static struct lock vmalloc_lock;   /* Protects VA_MAP. */
+static struct bitmap *va_map;      /* Used pages in the vmalloc window. */
+
+static void unmap_pages (uint8_t *va, size_t page_cnt);
+
+/* Initializes the vmalloc() window.  Must be called after
+   paging_init() and malloc_init(). */
+void
+vmalloc_init (void) {
+	lock_init (&vmalloc_lock);
+	va_map = bitmap_create (VMALLOC_SIZE / PGSIZE);
+	if (va_map == NULL)
+		PANIC ("vmalloc_init: out of memory");
+}
+
+/* Obtains and returns a virtually contiguous block of at least
+   SIZE bytes, backed by individually allocated kernel pages.
+   Returns a null pointer if address space or memory is not
+   available. */
+void *
+vmalloc (size_t size) {
+	struct vm_header *h;
+	size_t page_cnt, page_idx, i;
+
+	if (size == 0)
+		return NULL;
+	page_cnt = DIV_ROUND_UP (size + sizeof *h, PGSIZE);
+
+	lock_acquire (&vmalloc_lock);
+	page_idx = bitmap_scan_and_flip (va_map, 0, page_cnt, false);
+	lock_release (&vmalloc_lock);
+	if (page_idx == BITMAP_ERROR)
+		return NULL;
+
+	h = (struct vm_header *) (VMALLOC_START + page_idx * PGSIZE);
+	for (i = 0; i < page_cnt; i++) {
+		void *va = (uint8_t *) h + i * PGSIZE;
+		void *kpage = palloc_get_page (0);
+
+		if (kpage == NULL || !pml4_set_kernel_page (base_pml4, va, kpage)) {
+			palloc_free_page (kpage);
+			unmap_pages ((uint8_t *) h, i);
+
+			lock_acquire (&vmalloc_lock);
+			bitmap_set_multiple (va_map, page_idx, page_cnt, false);
+			lock_release (&vmalloc_lock);
+			return NULL;
+		}
+	}
+
+	h->magic = VMALLOC_MAGIC;
+	h->page_cnt = page_cnt;
+	return h + 1;
+}
+
+/* Allocates and return A times B bytes initialized to zeroes
+   with vmalloc().  Returns a null pointer if memory is not
+   available. */
+void *
+vcalloc (size_t a, size_t b) {
+	void *p;
+	size_t size;
+
+	/* Calculate block size and make sure it fits in size_t. */
+	size = a * b;
+	if (size < a || size < b)
+		return NULL;
+
+	p = vmalloc (size);
+	if (p != NULL)
+		memset (p, 0, size);
+	return p;
+}
+
+/* Frees block P, which must have been previously allocated with
+   vmalloc() or vcalloc(). */
+void
+vfree (void *p) {
+	struct vm_header *h;
+	size_t page_cnt;
+
+	if (p == NULL)
+		return;
+
+	h = pg_round_down (p);
+	ASSERT (is_vmalloc_vaddr (h));
+	ASSERT (h->magic == VMALLOC_MAGIC);
+	ASSERT (p == h + 1);
+
+	page_cnt = h->page_cnt;
+	unmap_pages ((uint8_t *) h, page_cnt);
+
+	lock_acquire (&vmalloc_lock);
+	ASSERT (bitmap_all (va_map, pg_no ((uint64_t) h - VMALLOC_START),
+				page_cnt));
+	bitmap_set_multiple (va_map, pg_no ((uint64_t) h - VMALLOC_START),
+			page_cnt, false);
+	lock_release (&vmalloc_lock);
+}
+
+/* Unmaps the PAGE_CNT pages starting at VA and returns their
+   frames to the page allocator. */
+static void
+unmap_pages (uint8_t *va, size_t page_cnt) {
+	size_t i;
+
+	for (i = 0; i < page_cnt; i++)
+		palloc_free_page (pml4_clear_kernel_page (base_pml4, va + i * PGSIZE));
+}
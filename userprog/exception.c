@@ -3,7 +3,9 @@
 #include <stdio.h>
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
+#include "threads/mmu.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "intrinsic.h"
 
 #include "userprog/syscall.h" // P2
@@ -13,6 +15,25 @@ static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static bool fixup_user_access (struct intr_frame *);
+
+/* Kernel instructions that access user memory, in
+   userprog/usercopy-loops.S, and where each one resumes if it faults. */
+extern const char usercopy_copy_insn[], usercopy_copy_fixup[];
+extern const char usercopy_strncpy_load[], usercopy_strncpy_store[];
+extern const char usercopy_strncpy_fixup[];
+
+/* Exception fixup table. */
+struct fixup {
+	const char *insn;           /* Address of a faulting instruction. */
+	const char *resume;         /* Where to continue instead. */
+};
+
+static const struct fixup fixups[] = {
+	{ usercopy_copy_insn, usercopy_copy_fixup },
+	{ usercopy_strncpy_load, usercopy_strncpy_fixup },
+	{ usercopy_strncpy_store, usercopy_strncpy_fixup },
+};
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -151,6 +172,19 @@ page_fault (struct intr_frame *f) {
 	/* Count page faults. */
 	page_fault_cnt++;
 
+#ifndef VM
+	/* A write to a page shared copy-on-write since fork gets its
+	   own copy of the page and retries. */
+	if (write && !not_present && is_user_vaddr (fault_addr)
+			&& pml4_break_cow (thread_current ()->pml4, fault_addr))
+		return;
+#endif
+
+	/* A bad user pointer that the kernel was copying through
+	   fails the copy, not the kernel. */
+	if (!user && is_user_vaddr (fault_addr) && fixup_user_access (f))
+		return;
+
 	// kill page fault (P2)
 	syscall_terminate();
 
@@ -163,3 +197,18 @@ page_fault (struct intr_frame *f) {
 	kill (f);
 }
 
+/* If the kernel instruction that faulted in F is one that is
+   expected to fault on bad user addresses, arranges for F to
+   resume at its fixup and returns true.  Otherwise returns
+   false. */
+static bool
+fixup_user_access (struct intr_frame *f) {
+	size_t i;
+
+	for (i = 0; i < sizeof fixups / sizeof *fixups; i++)
+		if (f->rip == (uintptr_t) fixups[i].insn) {
+			f->rip = (uintptr_t) fixups[i].resume;
+			return true;
+		}
+	return false;
+}
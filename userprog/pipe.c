@@ -0,0 +1,179 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Pages in a pipe's buffer.  The capacity must be a power of
+   two, so that the free-running positions below can be masked
+   into the buffer. */
+#define PIPE_PAGES 1
+#define PIPE_SIZE (PIPE_PAGES * PGSIZE)
+
+/* An anonymous pipe. */
+struct pipe {
+	struct lock lock;           /* Protects the members below. */
+	struct condition readable;  /* Signaled when data or EOF arrives. */
+	struct condition writable;  /* Signaled when space frees up. */
+	uint8_t *buf;               /* PIPE_SIZE bytes of ring buffer. */
+	size_t head;                /* Total bytes ever written. */
+	size_t tail;                /* Total bytes ever read. */
+	int readers;                /* References to the read end. */
+	int writers;                /* References to the write end. */
+};
+
+/* Creates a pipe with one reference to each end.  Returns the
+   new pipe, or a null pointer if memory is exhausted. */
+struct pipe *
+pipe_create (void) {
+	struct pipe *p = malloc (sizeof *p);
+
+	if (p == NULL)
+		return NULL;
+	p->buf = palloc_get_multiple (0, PIPE_PAGES);
+	if (p->buf == NULL) {
+		free (p);
+		return NULL;
+	}
+	lock_init (&p->lock);
+	cond_init (&p->readable);
+	cond_init (&p->writable);
+	p->head = p->tail = 0;
+	p->readers = p->writers = 1;
+	return p;
+}
+
+/* Adds a reference to P's write end if WRITER is true, otherwise
+   to its read end, as when a descriptor is inherited by fork. */
+void
+pipe_open (struct pipe *p, bool writer) {
+	lock_acquire (&p->lock);
+	if (writer)
+		p->writers++;
+	else
+		p->readers++;
+	lock_release (&p->lock);
+}
+
+/* Drops a reference to P's write end if WRITER is true,
+   otherwise to its read end.  Waiters on the other end are woken
+   so that they can see EOF or a broken pipe, as are pollers.
+   Frees P when both
+   ends are gone. */
+void
+pipe_close (struct pipe *p, bool writer) {
+	bool dead;
+
+	lock_acquire (&p->lock);
+	if (writer) {
+		ASSERT (p->writers > 0);
+		p->writers--;
+	} else {
+		ASSERT (p->readers > 0);
+		p->readers--;
+	}
+	cond_broadcast (&p->readable, &p->lock);
+	cond_broadcast (&p->writable, &p->lock);
+	dead = p->readers == 0 && p->writers == 0;
+	lock_release (&p->lock);
+	thread_poll_wake ();
+
+	if (dead) {
+		palloc_free_multiple (p->buf, PIPE_PAGES);
+		free (p);
+	}
+}
+
+/* Reads up to SIZE bytes from P into BUF and returns the number
+   of bytes read.  If P is empty and WAIT is true, first blocks
+   until some data arrives or the write end is closed.  Returns 0
+   at EOF, or if P is empty and WAIT is false. */
+size_t
+pipe_read (struct pipe *p, void *buf_, size_t size, bool wait) {
+	uint8_t *buf = buf_;
+	size_t n, ofs, first;
+
+	lock_acquire (&p->lock);
+	while (wait && p->head == p->tail && p->writers > 0)
+		cond_wait (&p->readable, &p->lock);
+
+	n = p->head - p->tail;
+	if (n > size)
+		n = size;
+	ofs = p->tail % PIPE_SIZE;
+	first = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+	memcpy (buf, p->buf + ofs, first);
+	memcpy (buf + first, p->buf, n - first);
+	p->tail += n;
+
+	if (n > 0)
+		cond_broadcast (&p->writable, &p->lock);
+	lock_release (&p->lock);
+	if (n > 0)
+		thread_poll_wake ();
+	return n;
+}
+
+/* Writes SIZE bytes from BUF to P, blocking while P is full, and
+   returns the number of bytes written.  This is less than SIZE
+   only if the read end is closed partway through.  Returns -1 if
+   the read end was closed before anything could be written. */
+int
+pipe_write (struct pipe *p, const void *buf_, size_t size) {
+	const uint8_t *buf = buf_;
+	size_t written = 0;
+
+	lock_acquire (&p->lock);
+	while (written < size) {
+		size_t n, ofs, first;
+
+		while (p->head - p->tail == PIPE_SIZE && p->readers > 0)
+			cond_wait (&p->writable, &p->lock);
+		if (p->readers == 0)
+			break;
+
+		n = PIPE_SIZE - (p->head - p->tail);
+		if (n > size - written)
+			n = size - written;
+		ofs = p->head % PIPE_SIZE;
+		first = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+		memcpy (p->buf + ofs, buf + written, first);
+		memcpy (p->buf, buf + written + first, n - first);
+		p->head += n;
+		written += n;
+
+		cond_broadcast (&p->readable, &p->lock);
+	}
+	lock_release (&p->lock);
+	if (written > 0)
+		thread_poll_wake ();
+
+	return written > 0 || size == 0 ? (int) written : -1;
+}
+
+/* Returns the poll events ready on P's write end if WRITER is
+   true, otherwise on its read end. */
+int
+pipe_poll (struct pipe *p, bool writer) {
+	int events = 0;
+
+	lock_acquire (&p->lock);
+	if (writer) {
+		if (p->readers == 0)
+			events |= POLLERR;
+		else if (p->head - p->tail < PIPE_SIZE)
+			events |= POLLOUT;
+	} else {
+		if (p->head != p->tail)
+			events |= POLLIN;
+		if (p->writers == 0)
+			events |= POLLHUP;
+	}
+	lock_release (&p->lock);
+	return events;
+}
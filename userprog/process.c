@@ -7,9 +7,11 @@
 #include <string.h>
 #include "userprog/gdt.h"
 #include "userprog/tss.h"
+#include "userprog/syscall.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h"
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
@@ -23,12 +25,15 @@
 #endif
 
 #include "threads/synch.h" // P2
+#include "threads/malloc.h"
+#include <spawn.h>
 // #include "userprog/syscall.h" // P2
 
 static void process_cleanup (void);
 static bool load (const char *file_name, struct intr_frame *if_);
 static void initd (void *f_name);
 static void __do_fork (void *);
+static void __do_spawn (void *);
 
 /* General process initializer for initd and other process. */
 static void
@@ -146,9 +151,6 @@ static bool
 duplicate_pte (uint64_t *pte, void *va, void *aux) {
 	struct thread *current = thread_current ();
 	struct thread *parent = (struct thread *) aux;
-	void *parent_page;
-	void *newpage;
-	bool writable;
 
 	/* 1. TODO: If the parent_page is kernel page, then return immediately. */
 
@@ -164,41 +166,15 @@ duplicate_pte (uint64_t *pte, void *va, void *aux) {
 		return true;
 	}
 
-	// printf("[DBG] duplicate_pte(): pte is user, va = %p\n", va); ///////////////////
-
-	/* 2. Resolve VA from the parent's page map level 4. */
-	parent_page = pml4_get_page (parent->pml4, va);
-
-	// printf("[DBG] duplicate_pte(): parent_page at %p\n", parent_page); ///////////////////
-
-	/* 3. TODO: Allocate new PAL_USER page for the child and set result to
-	 *    TODO: NEWPAGE. */
-
-	newpage = palloc_get_page(PAL_USER); // 기존 pte에 대응되는 새로운 페이지 할당
-	if (newpage == NULL) {
-		// 할당 실패
-		return false;
-	}
-
-	// printf("[DBG] duplicate_pte(): newpage at %p\n", newpage); ///////////////////
-
-	/* 4. TODO: Duplicate parent's page to the new page and
-	 *    TODO: check whether parent's page is writable or not (set WRITABLE
-	 *    TODO: according to the result). */
-
-	memcpy(newpage, parent_page, PGSIZE); // 할당된 페이지로 데이터 복사
-	// writable = (uint64_t) *pte & PTE_W; // 기존 pte의 writable 여부
-	writable = is_writable(pte);
-
-	// printf("[DBG] duplicate_pte(): pte writable is %d\n", writable); ///////////////////
-
-	/* 5. Add new page to child's page table at address VA with WRITABLE
-	 *    permission. */
-	if (!pml4_set_page (current->pml4, va, newpage, writable)) {
+	/* 2-5. 페이지를 복사하지 않고 부모의 프레임을 copy-on-write로 공유한다.
+	 *      쓰기 가능한 페이지는 부모와 자식 모두 읽기 전용이 되고, 먼저
+	 *      쓰는 쪽이 page fault에서 자기 복사본을 받는다 (pml4_break_cow).
+	 *      부모의 pml4가 활성화되어 있으면 pml4_share_page가 TLB 항목을
+	 *      invlpg로 비우고, 아니면 부모로 돌아갈 때 schedule()의
+	 *      process_activate()가 CR3를 다시 로드하며 비운다. */
+	if (!pml4_share_page (current->pml4, va, parent->pml4, pte)) {
 		/* 6. TODO: if fail to insert page, do error handling. */
-		// printf("process.c - duplicate_pte() - pml4_set_page() failed!!!!!!!!!!\n "); //////////// WIP
 		return false;
-		// syscall_terminate();
 	}
 	return true;
 }
@@ -323,7 +299,7 @@ __do_fork (void *aux) {
 	 * TODO:       the resources of parent.*/
 
 	// printf("[DBG] __do_fork(): HI! I'm {%s}. fd duplication goes here\n", current->name); ////////////
-	if (!thread_dup_file_list(parent, current)) { // parent의 file_list를 복사
+	if (!thread_dup_fd_table(parent, current)) { // parent의 fd_table을 복사
 		goto error;
 	}
 	process_init ();
@@ -359,6 +335,110 @@ error:
 	thread_exit ();
 }
 
+// process_spawn()에서 thread_create의 인자로 전달할 구조체
+struct spawn_args {
+	struct thread *parent;
+	char *cmd_line; // palloc으로 할당된 명령줄, 자식이 load 후 해제
+	const struct spawn_action *actions;
+	int action_cnt;
+	struct semaphore spawn_sema;
+};
+
+// P2
+// cmd_line을 실행하는 자식 프로세스를 부모의 주소 공간을 복사하지 않고 바로 load해서 만듦
+// 자식은 부모의 fd_table을 물려받은 뒤 actions의 action_cnt개 동작을 차례로 적용
+// fork 후 바로 exec하는 경우의 페이지 복사와 해제를 생략
+// 자식의 tid를 반환, 실패 시 TID_ERROR 반환. cmd_line 페이지는 항상 해제됨
+tid_t
+process_spawn (char *cmd_line, const struct spawn_action *actions, int action_cnt) {
+	struct spawn_args sargs;
+	char name[16];
+
+	// 프로그램 이름을 쓰레드 이름으로 사용
+	strlcpy (name, cmd_line, sizeof name);
+	name[strcspn (name, " ")] = '\0';
+
+	sargs.parent = thread_current ();
+	sargs.cmd_line = cmd_line;
+	sargs.actions = actions;
+	sargs.action_cnt = action_cnt;
+	sema_init (&sargs.spawn_sema, 0); // load가 끝날 때까지 부모를 대기시키는 sema
+
+	tid_t tid = thread_create (name, PRI_DEFAULT, __do_spawn, &sargs);
+	if (tid == TID_ERROR) {
+		palloc_free_page (cmd_line);
+		return TID_ERROR;
+	}
+
+	sema_down (&sargs.spawn_sema); // __do_spawn이 load를 마칠 때까지 대기
+	struct thread *t = thread_get_by_id (tid);
+	if (t->p_tid == TID_ERROR) {
+		// fork와 마찬가지로 실패한 자식은 부모가 바로 reap
+		sema_up (&t->reap_sema);
+		tid = TID_ERROR;
+	}
+	return tid;
+}
+
+// spawn의 fd 동작들을 현재 프로세스의 fd_table에 차례로 적용, 실패 시 false 반환
+static bool
+apply_spawn_actions (const struct spawn_action *actions, int action_cnt) {
+	for (int i = 0; i < action_cnt; i++) {
+		const struct spawn_action *a = &actions[i];
+		struct file_elem *fe;
+
+		switch (a->op) {
+			case SPAWN_CLOSE:
+				if ((fe = thread_remove_fe (a->fd)) == NULL) {
+					return false;
+				}
+				thread_put_fe (fe);
+				break;
+			case SPAWN_DUP2:
+				if (!thread_dup_fe (a->fd, a->newfd)) {
+					return false;
+				}
+				break;
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+// P2
+static void
+__do_spawn (void *aux) {
+	struct spawn_args *sargs = (struct spawn_args *) aux;
+	struct thread *current = thread_current ();
+	struct intr_frame if_;
+	bool success;
+
+	memset (&if_, 0, sizeof if_);
+	if_.ds = if_.es = if_.ss = SEL_UDSEG;
+	if_.cs = SEL_UCSEG;
+	if_.eflags = FLAG_IF | FLAG_MBS;
+
+#ifdef VM
+	supplemental_page_table_init (&current->spt);
+#endif
+
+	// 부모는 sema_down 중이므로 부모의 fd_table을 그대로 읽어도 안전
+	success = thread_dup_fd_table (sargs->parent, current)
+		&& apply_spawn_actions (sargs->actions, sargs->action_cnt)
+		&& load (sargs->cmd_line, &if_);
+	palloc_free_page (sargs->cmd_line);
+
+	if (success) {
+		process_init ();
+		sema_up (&sargs->spawn_sema); // 대기중인 부모 프로세스를 깨운다
+		do_iret (&if_);
+	}
+	current->p_tid = TID_ERROR; // spawn 실패 시 부모 tid를 -1로 설정
+	sema_up (&sargs->spawn_sema);
+	thread_exit ();
+}
+
 /* Switch the current execution context to the f_name.
  * Returns -1 on fail. */
 int
@@ -440,12 +520,13 @@ process_exit (void) {
 	if (curr->is_user) {
 		printf ("%s: exit(%d)\n", curr->name, curr->exit_status); ////////////////////
 	}
+	syscall_release_stats (); // 시스템 콜 통계 출력 (-sc) 및 해제
 
 	// printf("[DBG] process_exit(): {%s} will wake waiting parent\n", curr->name); //////////////
 	sema_up(&thread_current()->wait_sema); // 대기중인 부모를 깨움
 
 	// printf("[DBG] process_exit(): {%s} waked parents, now will wait for reap\n", curr->name); //////////////
-	thread_clear_file_list(); // file_list에 속한 모든 파일을 닫고 리스트 삭제
+	thread_clear_fd_table(curr); // fd_table에 등록된 모든 파일을 닫고 table 삭제
 
 	process_cleanup ();
 
@@ -552,6 +633,35 @@ struct ELF64_PHDR {
 #define ELF ELF64_hdr
 #define Phdr ELF64_PHDR
 
+/* A PT_LOAD segment, ready for load_segment(). */
+struct elf_segment {
+	uint64_t file_page;         /* Page-aligned offset in the file. */
+	uint64_t mem_page;          /* Page-aligned user virtual address. */
+	uint32_t read_bytes;        /* Bytes to read from the file. */
+	uint32_t zero_bytes;        /* Bytes to zero after them. */
+	bool writable;              /* Mapped writable? */
+};
+
+/* An executable's parsed and validated ELF headers.  Images are
+ * cached, so that exec of a binary that ran recently reads and
+ * checks none of its headers again. */
+struct elf_image {
+	struct list_elem elem;      /* Element in elf_cache. */
+	disk_sector_t sector;       /* Executable's inode sector. */
+	uint64_t version;           /* Inode's version when parsed. */
+	int ref_cnt;                /* Cache's reference plus loaders'. */
+	uint64_t entry;             /* Entry point. */
+	int seg_cnt;                /* Number of SEGS. */
+	struct elf_segment segs[];  /* PT_LOAD segments. */
+};
+
+/* Most recently used images first, up to ELF_CACHE_MAX of them. */
+#define ELF_CACHE_MAX 8
+static struct list elf_cache;
+static struct lock elf_cache_lock;
+
+static struct elf_image *elf_image_get (struct file *, const char *file_name);
+static void elf_image_put (struct elf_image *);
 static bool setup_stack (struct intr_frame *if_);
 static bool validate_segment (const struct Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
@@ -565,9 +675,8 @@ static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
 static bool
 load (const char *file_name, struct intr_frame *if_) {
 	struct thread *t = thread_current ();
-	struct ELF ehdr;
+	struct elf_image *image = NULL;
 	struct file *file = NULL;
-	off_t file_ofs;
 	bool success = false;
 	int i;
 
@@ -593,69 +702,18 @@ load (const char *file_name, struct intr_frame *if_) {
 		goto done;
 	}
 
-	/* Read and verify executable header. */
-	if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
-			|| memcmp (ehdr.e_ident, "\177ELF\2\1\1", 7)
-			|| ehdr.e_type != 2
-			|| ehdr.e_machine != 0x3E // amd64
-			|| ehdr.e_version != 1
-			|| ehdr.e_phentsize != sizeof (struct Phdr)
-			|| ehdr.e_phnum > 1024) {
-		printf ("load: %s: error loading executable\n", file_name);
+	/* Parse the ELF headers, or find them already parsed. */
+	image = elf_image_get (file, file_name);
+	if (image == NULL)
 		goto done;
-	}
-
-	/* Read program headers. */
-	file_ofs = ehdr.e_phoff;
-	for (i = 0; i < ehdr.e_phnum; i++) {
-		struct Phdr phdr;
 
-		if (file_ofs < 0 || file_ofs > file_length (file))
-			goto done;
-		file_seek (file, file_ofs);
+	/* Load the segments. */
+	for (i = 0; i < image->seg_cnt; i++) {
+		const struct elf_segment *seg = &image->segs[i];
 
-		if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
+		if (!load_segment (file, seg->file_page, (void *) seg->mem_page,
+					seg->read_bytes, seg->zero_bytes, seg->writable))
 			goto done;
-		file_ofs += sizeof phdr;
-		switch (phdr.p_type) {
-			case PT_NULL:
-			case PT_NOTE:
-			case PT_PHDR:
-			case PT_STACK:
-			default:
-				/* Ignore this segment. */
-				break;
-			case PT_DYNAMIC:
-			case PT_INTERP:
-			case PT_SHLIB:
-				goto done;
-			case PT_LOAD:
-				if (validate_segment (&phdr, file)) {
-					bool writable = (phdr.p_flags & PF_W) != 0;
-					uint64_t file_page = phdr.p_offset & ~PGMASK;
-					uint64_t mem_page = phdr.p_vaddr & ~PGMASK;
-					uint64_t page_offset = phdr.p_vaddr & PGMASK;
-					uint32_t read_bytes, zero_bytes;
-					if (phdr.p_filesz > 0) {
-						/* Normal segment.
-						 * Read initial part from disk and zero the rest. */
-						read_bytes = page_offset + phdr.p_filesz;
-						zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-								- read_bytes);
-					} else {
-						/* Entirely zero.
-						 * Don't read anything from disk. */
-						read_bytes = 0;
-						zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
-					}
-					if (!load_segment (file, file_page, (void *) mem_page,
-								read_bytes, zero_bytes, writable))
-						goto done;
-				}
-				else
-					goto done;
-				break;
-		}
 	}
 
 	/* Set up stack. */
@@ -663,7 +721,7 @@ load (const char *file_name, struct intr_frame *if_) {
 		goto done;
 
 	/* Start address. */
-	if_->rip = ehdr.e_entry;
+	if_->rip = image->entry;
 
 	// printf("[DBG] load(): file_name = %s\n", file_name); //////////////////////////
 
@@ -764,6 +822,7 @@ load (const char *file_name, struct intr_frame *if_) {
 
 done:
 	/* We arrive here whether the load is successful or not. */
+	elf_image_put (image);
 	if (file) {
 		file_deny_write(file); // 실행중인 파일 수정을 막기 위해 파일을 열어둠
 	}
@@ -817,6 +876,173 @@ validate_segment (const struct Phdr *phdr, struct file *file) {
 	return true;
 }
 
+/* Reads and validates the ELF headers of FILE, named FILE_NAME, into
+ * a new image.  Returns a null pointer if FILE is not a loadable
+ * executable or memory runs out. */
+static struct elf_image *
+elf_image_parse (struct file *file, const char *file_name) {
+	struct ELF ehdr;
+	struct Phdr *phdrs = NULL;
+	struct elf_image *image = NULL;
+	size_t phdrs_size;
+	int i;
+
+	/* Read and verify executable header. */
+	if (file_read_at (file, &ehdr, sizeof ehdr, 0) != sizeof ehdr
+			|| memcmp (ehdr.e_ident, "\177ELF\2\1\1", 7)
+			|| ehdr.e_type != 2
+			|| ehdr.e_machine != 0x3E // amd64
+			|| ehdr.e_version != 1
+			|| ehdr.e_phentsize != sizeof (struct Phdr)
+			|| ehdr.e_phnum > 1024) {
+		printf ("load: %s: error loading executable\n", file_name);
+		return NULL;
+	}
+
+	/* Read program headers, all at once. */
+	phdrs_size = ehdr.e_phnum * sizeof *phdrs;
+	if (ehdr.e_phoff > (uint64_t) file_length (file))
+		return NULL;
+	image = malloc (sizeof *image + ehdr.e_phnum * sizeof *image->segs);
+	if (image == NULL)
+		return NULL;
+	if (phdrs_size > 0) {
+		phdrs = malloc (phdrs_size);
+		if (phdrs == NULL
+				|| file_read_at (file, phdrs, phdrs_size, ehdr.e_phoff)
+					!= (off_t) phdrs_size)
+			goto error;
+	}
+
+	image->entry = ehdr.e_entry;
+	image->seg_cnt = 0;
+	for (i = 0; i < ehdr.e_phnum; i++) {
+		const struct Phdr *phdr = &phdrs[i];
+		struct elf_segment *seg;
+		uint64_t page_offset;
+
+		switch (phdr->p_type) {
+			case PT_NULL:
+			case PT_NOTE:
+			case PT_PHDR:
+			case PT_STACK:
+			default:
+				/* Ignore this segment. */
+				break;
+			case PT_DYNAMIC:
+			case PT_INTERP:
+			case PT_SHLIB:
+				goto error;
+			case PT_LOAD:
+				if (!validate_segment (phdr, file))
+					goto error;
+				seg = &image->segs[image->seg_cnt++];
+				seg->writable = (phdr->p_flags & PF_W) != 0;
+				seg->file_page = phdr->p_offset & ~PGMASK;
+				seg->mem_page = phdr->p_vaddr & ~PGMASK;
+				page_offset = phdr->p_vaddr & PGMASK;
+				if (phdr->p_filesz > 0) {
+					/* Normal segment.
+					 * Read initial part from disk and zero the rest. */
+					seg->read_bytes = page_offset + phdr->p_filesz;
+					seg->zero_bytes = (ROUND_UP (page_offset + phdr->p_memsz, PGSIZE)
+							- seg->read_bytes);
+				} else {
+					/* Entirely zero.
+					 * Don't read anything from disk. */
+					seg->read_bytes = 0;
+					seg->zero_bytes = ROUND_UP (page_offset + phdr->p_memsz, PGSIZE);
+				}
+				break;
+		}
+	}
+	free (phdrs);
+	return image;
+
+error:
+	free (phdrs);
+	free (image);
+	return NULL;
+}
+
+/* Initializes the ELF image cache.  Called once at boot. */
+void
+process_cache_init (void) {
+	list_init (&elf_cache);
+	lock_init (&elf_cache_lock);
+}
+
+/* Drops a reference to IMAGE, freeing it if that was the last one.
+ * Must be called with elf_cache_lock held. */
+static void
+release_image (struct elf_image *image) {
+	ASSERT (lock_held_by_current_thread (&elf_cache_lock));
+	ASSERT (image->ref_cnt > 0);
+
+	if (--image->ref_cnt == 0)
+		free (image);
+}
+
+/* Returns the ELF image of FILE, named FILE_NAME, from the cache if
+ * FILE has not been written since it was parsed, or else parses it
+ * and caches the result.  The caller must release the image with
+ * elf_image_put().  Returns a null pointer if FILE is not a loadable
+ * executable or memory runs out. */
+static struct elf_image *
+elf_image_get (struct file *file, const char *file_name) {
+	struct inode *inode = file_get_inode (file);
+	disk_sector_t sector = inode_get_inumber (inode);
+	uint64_t version = inode_version (inode);
+	struct elf_image *image;
+	struct list_elem *e, *next;
+
+	lock_acquire (&elf_cache_lock);
+	for (e = list_begin (&elf_cache); e != list_end (&elf_cache); e = next) {
+		next = list_next (e);
+		image = list_entry (e, struct elf_image, elem);
+		if (image->sector != sector)
+			continue;
+
+		list_remove (e);
+		if (image->version == version) {
+			/* Hit.  Move it to the front. */
+			list_push_front (&elf_cache, e);
+			image->ref_cnt++;
+			lock_release (&elf_cache_lock);
+			return image;
+		}
+		/* Written since it was parsed. */
+		release_image (image);
+	}
+	lock_release (&elf_cache_lock);
+
+	image = elf_image_parse (file, file_name);
+	if (image == NULL)
+		return NULL;
+	image->sector = sector;
+	image->version = version;
+	image->ref_cnt = 2;
+
+	lock_acquire (&elf_cache_lock);
+	list_push_front (&elf_cache, &image->elem);
+	if (list_size (&elf_cache) > ELF_CACHE_MAX)
+		release_image (list_entry (list_pop_back (&elf_cache),
+					struct elf_image, elem));
+	lock_release (&elf_cache_lock);
+	return image;
+}
+
+/* Releases IMAGE, obtained from elf_image_get(), if it is not
+ * null. */
+static void
+elf_image_put (struct elf_image *image) {
+	if (image == NULL)
+		return;
+	lock_acquire (&elf_cache_lock);
+	release_image (image);
+	lock_release (&elf_cache_lock);
+}
+
 #ifndef VM
 /* Codes of this block will be ONLY USED DURING project 2.
  * If you want to implement the function for whole project 2, implement it
@@ -836,6 +1062,8 @@ static bool install_page (void *upage, void *kpage, bool writable);
  *
  * The pages initialized by this function must be writable by the
  * user process if WRITABLE is true, read-only otherwise.
+ * Read-only pages are shared with every other process running
+ * the same executable (see inode_get_text_page()).
  *
  * Return true if successful, false if a memory allocation error
  * or disk read error occurs. */
@@ -846,25 +1074,34 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 	ASSERT (pg_ofs (upage) == 0);
 	ASSERT (ofs % PGSIZE == 0);
 
-	file_seek (file, ofs);
 	while (read_bytes > 0 || zero_bytes > 0) {
 		/* Do calculate how to fill this page.
 		 * We will read PAGE_READ_BYTES bytes from FILE
 		 * and zero the final PAGE_ZERO_BYTES bytes. */
 		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
 		size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-		/* Get a page of memory. */
-		uint8_t *kpage = palloc_get_page (PAL_USER);
-		if (kpage == NULL)
-			return false;
-
-		/* Load this page. */
-		if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes) {
-			palloc_free_page (kpage);
-			return false;
+		uint8_t *kpage;
+
+		if (!writable) {
+			/* Map the shared copy of this page. */
+			kpage = inode_get_text_page (file_get_inode (file), ofs,
+					page_read_bytes);
+			if (kpage == NULL)
+				return false;
+		} else {
+			/* Get a page of memory. */
+			kpage = palloc_get_page (PAL_USER);
+			if (kpage == NULL)
+				return false;
+
+			/* Load this page. */
+			if (file_read_at (file, kpage, page_read_bytes, ofs)
+					!= (int) page_read_bytes) {
+				palloc_free_page (kpage);
+				return false;
+			}
+			memset (kpage + page_read_bytes, 0, page_zero_bytes);
 		}
-		memset (kpage + page_read_bytes, 0, page_zero_bytes);
 
 		/* Add the page to the process's address space. */
 		if (!install_page (upage, kpage, writable)) {
@@ -876,6 +1113,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 		/* Advance. */
 		read_bytes -= page_read_bytes;
 		zero_bytes -= page_zero_bytes;
+		ofs += PGSIZE;
 		upage += PGSIZE;
 	}
 	return true;
@@ -14,14 +14,48 @@
 // #include "threads/malloc.h"
 #include "userprog/process.h"
 // #include "threads/interrupt.h"
-// #include <string.h>
+#include <string.h>
 #include "threads/palloc.h"
-// #include "threads/synch.h"
+#include "threads/synch.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/vmalloc.h"
+#include "userprog/usercopy.h"
+#include "userprog/pipe.h"
+#include <uio.h>
+#include <uring.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sysstat.h>
+#include "devices/input.h"
+#include "devices/timer.h"
+#include <console.h>
 
 #define PUTBUF_MAX 512 // stdout으로 putbuf할 때의 최대 바이트 수
+#define COPY_CHUNK 512 // 사용자 버퍼와 파일 사이를 한 번에 옮기는 바이트 수
+#define PATH_BUF 256 // 사용자 문자열(파일 이름 등)을 복사할 커널 버퍼 크기
 
 // struct lock file_lock; // 읽기
 
+/* -sc: Print each process's system call statistics when it
+   exits? */
+bool syscall_print_stats;
+
+// 통계를 출력할 때 쓰는 시스템 콜 이름 (SYS_* 순서)
+static const char *syscall_names[SYS_CNT] = {
+	"halt", "exit", "fork", "exec", "wait", "create", "remove", "open",
+	"filesize", "read", "write", "seek", "tell", "close",
+	"mmap", "munmap",
+	"chdir", "mkdir", "readdir", "isdir", "inumber", "symlink",
+	"dup2", "mount", "umount",
+	"memstat", "dmesg",
+	"readv", "writev", "pread", "pwrite", "copy_file_range",
+	"pipe", "poll",
+	"uring_enter",
+	"spawn",
+	"sysstat",
+};
+
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
 
@@ -34,64 +68,51 @@ void syscall_handler (struct intr_frame *);
 // struct file_elem stdin_fe;
 // struct file_elem stdout_fe;
 
-// file_elem의 fd를 비교 (P2)
-bool file_elem_fd_less(const struct list_elem *a,
-	const struct list_elem *b, void *aux) {
-	struct file_elem *fea = list_entry(a, struct file_elem, elem);
-	struct file_elem *feb = list_entry(b, struct file_elem, elem);
-
-	return fea->fd < feb->fd;
-}
-
-
-// file_list에서 fd에 해당하는 file_elem 구조체를 반환
+// fd_table에서 fd에 해당하는 file_elem 구조체를 반환
 static struct file_elem *get_file_in_list(int fd) {
-	struct list *file_list = &thread_current()->file_list;
-	struct list_elem *e;
-	struct file_elem *fe;
-
-	for (e = list_begin(file_list); e != list_end(file_list); e = list_next(e)) {
-		fe = list_entry(e, struct file_elem, elem);
-		if (fe->fd == fd) {
-			break;
-		}
-	}
-
-	if (e == list_end(file_list)) {
-		// fd에 해당하는 요소가 없음
-		return NULL;
-	}
-
-	return fe;
+	return thread_get_fe(fd);
 }
 
-// file을 file_list에 추가하고 file descriptor를 반환
+// file을 fd_table에 추가하고 file descriptor를 반환, 실패 시 -1 반환
 static int add_file_in_list(struct file *file) {
-	struct list *file_list = &thread_current()->file_list;
-	struct list_elem *e;
-	struct file_elem *fe;
-
-	// 파일에 할당되지않은 descriptor를 탐색
-	int idx = 0;
-	for (e = list_begin(file_list); e != list_end(file_list); e = list_next(e)) {
-		fe = list_entry(e, struct file_elem, elem);
-		if (fe->fd != idx) {
-			// file_list에서 idx에 해당하는 fd가 미할당 상태
-			break;
-		}
-		idx++;
+	struct file_elem *new_fe = malloc(sizeof(*new_fe));
+	if (new_fe == NULL) {
+		file_close(file);
+		return -1;
 	}
+	new_fe->file = file;
+	new_fe->std_no = -1;
+	new_fe->pipe = NULL;
+	new_fe->writer = false;
+	new_fe->ref_cnt = 1;
+
+	int fd = thread_add_fe(new_fe);
+	if (fd < 0) {
+		// fd_table을 늘릴 수 없음
+		thread_put_fe(new_fe);
+	}
+	return fd;
+}
 
-	// printf("[DBG] add_file_in_list(): new descriptor will be %d\n", idx); /////////////////////////////
+// 파이프의 한쪽 끝을 fd_table에 추가하고 file descriptor를 반환, 실패 시 -1 반환
+// 실패하면 그 끝은 닫힘
+static int add_pipe_in_list(struct pipe *pipe, bool writer) {
 	struct file_elem *new_fe = malloc(sizeof(*new_fe));
-	// struct file_elem *new_fe = palloc_get_page(PAL_USER);
-	new_fe->fd = idx;
-	new_fe->file = file;
+	if (new_fe == NULL) {
+		pipe_close(pipe, writer);
+		return -1;
+	}
+	new_fe->file = NULL;
 	new_fe->std_no = -1;
-	list_insert_ordered(file_list, &new_fe->elem, file_elem_fd_less, NULL);
-	// printf("[DBG] add_file_in_list(): inserted new file_elem into file_list\n"); //////////////////////
+	new_fe->pipe = pipe;
+	new_fe->writer = writer;
+	new_fe->ref_cnt = 1;
 
-	return new_fe->fd;
+	int fd = thread_add_fe(new_fe);
+	if (fd < 0) {
+		thread_put_fe(new_fe);
+	}
+	return fd;
 }
 
 
@@ -148,20 +169,30 @@ syscall_init (void) {
 	// list_push_back(&file_list, &stdout_fe->elem);
 }
 
-static bool is_valid_addr(void *p) {
-	// 유효한 주소가 아니면 terminate
-	//////////////////////////////////////////////////////////////////////////// WIP
+static void exit(int status);
 
-	if (p == NULL || p >= KERN_BASE) {
-		// printf("[DBG] is_valid_addr(): NULL or kernel address!\n"); /////////////////////
-		return false;
-	} else if (pml4_get_page (thread_current()->pml4, p) == NULL) {
-		// 매핑되지 않은 주소
-		// printf("[DBG] is_valid_addr(): invalid address!\n"); /////////////////////
-		return false;
+// 사용자 문자열 usrc를 커널 버퍼 dst(size 바이트)로 복사
+// 잘못된 주소면 프로세스를 종료하고, 문자열이 버퍼보다 길면 false 반환
+static bool get_user_string(char *dst, const char *usrc, size_t size) {
+	int64_t len = strncpy_from_user(dst, usrc, size);
+
+	if (len < 0) {
+		exit(-1);
 	}
+	return len < (int64_t) size;
+}
 
-	return true;
+// upage부터 left 바이트가 남은 사용자 버퍼에서 upage가 페이지 정렬되어 있고
+// 한 페이지 이상 남았다면, 그 페이지의 프레임에 대한 커널 주소를 반환
+// 파일과 사용자 프레임 사이를 복사 없이 옮기는 데 사용
+// 이 커널에는 프레임 교체가 없으므로 syscall 동안 프레임은 그대로 유지됨
+// 조건이 맞지 않거나 매핑되지 않은 페이지면 NULL 반환 (복사 경로로 처리)
+static void *get_user_frame(void *upage, unsigned left, bool write) {
+	if (pg_ofs(upage) != 0 || left < PGSIZE
+			|| (uint64_t) upage + PGSIZE > KERN_BASE) {
+		return NULL;
+	}
+	return pml4_get_user_page(thread_current()->pml4, upage, write);
 }
 
 ///////////////////////// DEBUG
@@ -208,10 +239,12 @@ static void exit(int status) {
 }
 
 tid_t fork(const char *thread_name, struct intr_frame *if_) {
-	if (!is_valid_addr(thread_name)) {
-		exit(-1);
+	char name[16]; // thread 이름 길이만큼만 사용됨
+
+	if (!get_user_string(name, thread_name, sizeof name)) {
+		name[sizeof name - 1] = '\0';
 	}
-	tid_t ret = process_fork(thread_name, if_);
+	tid_t ret = process_fork(name, if_);
 	// printf("[DBG] fork(): {%s} process_fork() is done! (child tid = %d)\n", thread_current()->name, ret); ////////////
 
 	// print_if(if_, "end of fork"); //////////////////
@@ -222,10 +255,6 @@ tid_t fork(const char *thread_name, struct intr_frame *if_) {
 }
 
 int exec(const char *cmd_line) {
-	if (!is_valid_addr(cmd_line)) {
-		exit(-1);
-	}
-
 	char *cmd_copy = palloc_get_page(0);
 	// char *dummy = palloc_get_page(0); //////////////////////
 	if (cmd_copy == NULL) {
@@ -235,7 +264,11 @@ int exec(const char *cmd_line) {
 	// printf("[DBG] exec(): copying cmd_line - %s at %p\n", cmd_line, cmd_line); //////////
 	// printf("[DBG] exec(): will copy to %p\n", cmd_copy); //////
 
-	strlcpy (cmd_copy, cmd_line, PGSIZE);
+	if (strncpy_from_user (cmd_copy, cmd_line, PGSIZE) < 0) {
+		palloc_free_page(cmd_copy);
+		exit(-1);
+	}
+	cmd_copy[PGSIZE - 1] = '\0';
 	// strlcpy (dummy, cmd_copy, PGSIZE); //////////////
 
 	// printf("[DBG] exec(): copied cmd_copy - %s at %p\n", cmd_copy, cmd_copy); ///////////////
@@ -249,6 +282,42 @@ int exec(const char *cmd_line) {
 	return -1;
 }
 
+// cmd_line을 실행하는 자식 프로세스를 주소 공간 복사 없이 만들고 tid를 반환, 실패 시 -1 반환
+// 자식은 부모의 fd를 물려받은 뒤 uactions의 action_cnt개 fd 동작을 적용
+static tid_t spawn(const char *cmd_line, const struct spawn_action *uactions, int action_cnt) {
+	if (action_cnt < 0 || action_cnt > SPAWN_ACTIONS_MAX) {
+		return -1;
+	}
+
+	struct spawn_action *actions = NULL;
+	if (action_cnt > 0) {
+		actions = malloc(action_cnt * sizeof(*actions));
+		if (actions == NULL) {
+			return -1;
+		}
+		if (!copy_from_user(actions, uactions, action_cnt * sizeof(*actions))) {
+			free(actions);
+			exit(-1);
+		}
+	}
+
+	char *cmd_copy = palloc_get_page(0);
+	if (cmd_copy == NULL) {
+		free(actions);
+		return -1;
+	}
+	if (strncpy_from_user(cmd_copy, cmd_line, PGSIZE) < 0) {
+		palloc_free_page(cmd_copy);
+		free(actions);
+		exit(-1);
+	}
+	cmd_copy[PGSIZE - 1] = '\0';
+
+	tid_t tid = process_spawn(cmd_copy, actions, action_cnt);
+	free(actions);
+	return tid;
+}
+
 int wait(tid_t tid) {
 	// printf("[DBG] {%s} called system cal WAIT(%d)!!!\n", thread_current()->name, tid); ///////////
 	int ret = process_wait(tid);
@@ -258,28 +327,38 @@ int wait(tid_t tid) {
 }
 
 static bool create(const char *file, unsigned initial_size) {
-	if (!is_valid_addr(file) || strlen(file) == 0) {
+	char name[PATH_BUF];
+
+	if (!get_user_string(name, file, sizeof name)) {
+		// 너무 긴 이름
+		return false;
+	}
+	if (strlen(name) == 0) {
 		exit(-1);
 	}
 
-	return filesys_create(file, initial_size);
+	return filesys_create(name, initial_size);
 }
 
 static bool remove(const char *file) {
-	if (!is_valid_addr(file)) {
-		exit(-1);
+	char name[PATH_BUF];
+
+	if (!get_user_string(name, file, sizeof name)) {
+		return false;
 	}
 
-	return filesys_remove (file);
+	return filesys_remove (name);
 }
 
 static int open(const char *file_name) {
 	// return 2; /////////////////////////////// 불구만들기 //////////////////////////////////////
-	if (!is_valid_addr(file_name)) {
-		exit(-1);
+	char name[PATH_BUF];
+
+	if (!get_user_string(name, file_name, sizeof name)) {
+		return -1;
 	}
 
-	struct file *file = filesys_open (file_name);
+	struct file *file = filesys_open (name);
 
 	if (file == NULL) {
 		return -1;
@@ -291,7 +370,7 @@ static int open(const char *file_name) {
 static int filesize(int fd) {
 	struct file_elem *fe = get_file_in_list(fd);
 	if (fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
+		// fd에 해당하는 파일이 fd_table에 없음
 		return -1;
 	}
 
@@ -306,80 +385,506 @@ static int filesize(int fd) {
 	}
 }
 
+// 파일 fe에서 ofs가 NULL이면 현재 위치, 아니면 *ofs 위치부터 읽고 *ofs를 전진
+static unsigned file_read_from(struct file_elem *fe, void *kbuf, unsigned size, off_t *ofs) {
+	if (ofs == NULL) {
+		return file_read (fe->file, kbuf, size);
+	}
+	off_t n = file_read_at (fe->file, kbuf, size, *ofs);
+	*ofs += n;
+	return n;
+}
+
+// 파일 fe에 ofs가 NULL이면 현재 위치, 아니면 *ofs 위치부터 쓰고 *ofs를 전진
+static unsigned file_write_to(struct file_elem *fe, const void *kbuf, unsigned size, off_t *ofs) {
+	if (ofs == NULL) {
+		return file_write (fe->file, kbuf, size);
+	}
+	off_t n = file_write_at (fe->file, kbuf, size, *ofs);
+	*ofs += n;
+	return n;
+}
+
+// 콘솔 입력 버퍼에 읽을 키가 있으면 true
+static bool stdin_ready(void) {
+	enum intr_level old_level = intr_disable();
+	bool ready = !input_empty();
+	intr_set_level(old_level);
+	return ready;
+}
+
+// fe에서 커널 버퍼 kbuf로 최대 size 바이트를 읽고 읽은 바이트 수를 반환
+// ofs는 file_read_from()과 같음
+static unsigned read_kernel(struct file_elem *fe, void *kbuf, unsigned size, off_t *ofs) {
+	if (fe->std_no == STDIN_FILENO) {
+		// stdin에서 읽기, 첫 키는 기다리지만 그 뒤로는 이미 들어온 키만 읽음
+		unsigned i;
+		for (i = 0; i < size && (i == 0 || stdin_ready()); i++) {
+			*((uint8_t *) kbuf + i) = input_getc();
+		}
+		return i;
+	}
+	if (fe->pipe != NULL) {
+		// 파이프에서 읽기, 비어 있으면 데이터가 들어올 때까지 대기
+		return pipe_read(fe->pipe, kbuf, size, true);
+	}
+	// 파일에서 읽기
+	return file_read_from(fe, kbuf, size, ofs);
+}
+
+// 커널 버퍼 kbuf의 size 바이트를 fe에 쓰고 쓴 바이트 수를 반환
+// ofs는 file_write_to()와 같음
+static unsigned write_kernel(struct file_elem *fe, const void *kbuf, unsigned size, off_t *ofs) {
+	if (fe->std_no == STDOUT_FILENO) {
+		// stdout으로 출력
+		const char *p = kbuf;
+		unsigned bytes_left = size;
+		while (bytes_left > 0) {
+			unsigned bytes_to_write = bytes_left < PUTBUF_MAX ? bytes_left : PUTBUF_MAX;
+			putbuf(p, bytes_to_write);
+			p += bytes_to_write;
+			bytes_left -= bytes_to_write;
+		}
+		return size;
+	}
+	if (fe->pipe != NULL) {
+		// 파이프에 쓰기, 읽는 쪽이 모두 닫혔으면 0
+		int n = pipe_write(fe->pipe, kbuf, size);
+		return n < 0 ? 0 : n;
+	}
+	// 파일에 쓰기
+	return file_write_to(fe, kbuf, size, ofs);
+}
+
+// fe에서 커널 버퍼 kbuf로 최대 size 바이트를 읽고 읽은 바이트 수를 반환
+// have_data면 (이미 읽은 데이터가 있으면) 파이프와 stdin에서 더 기다리지 않음
+static unsigned read_kernel_more(struct file_elem *fe, void *kbuf, unsigned size, off_t *ofs,
+		bool have_data) {
+	if (have_data && fe->pipe != NULL) {
+		return pipe_read(fe->pipe, kbuf, size, false);
+	}
+	if (have_data && fe->std_no == STDIN_FILENO && !stdin_ready()) {
+		return 0;
+	}
+	return read_kernel(fe, kbuf, size, ofs);
+}
+
+// fe에서 사용자 버퍼 buffer로 최대 size 바이트를 읽고 읽은 바이트 수를 반환
+// COPY_CHUNK씩 커널 버퍼로 읽은 뒤 사용자 버퍼로 복사
+// have_data는 read_kernel_more()와 같고, buffer가 잘못된 주소라면 *fault를 true로
+// 하고 멈춤 (호출자가 정리 후 종료), ofs는 file_read_from()과 같음
+static unsigned read_user(struct file_elem *fe, void *buffer, unsigned size, off_t *ofs,
+		bool have_data, bool *fault) {
+	char kbuf[COPY_CHUNK];
+	unsigned bytes_read = 0;
+	while (bytes_read < size) {
+		unsigned chunk = size - bytes_read < COPY_CHUNK ? size - bytes_read : COPY_CHUNK;
+		unsigned n;
+		void *kpage;
+
+		if (fe->file && (kpage = get_user_frame(buffer + bytes_read, size - bytes_read, true))) {
+			// 사용자 프레임으로 바로 읽기 (복사 없음)
+			chunk = PGSIZE;
+			n = file_read_from(fe, kpage, chunk, ofs);
+		} else {
+			n = read_kernel_more(fe, kbuf, chunk, ofs, have_data || bytes_read > 0);
+			if (n > 0 && !copy_to_user(buffer + bytes_read, kbuf, n)) {
+				*fault = true;
+				break;
+			}
+		}
+
+		bytes_read += n;
+		if (n < chunk) {
+			// 파일의 끝이거나 파이프나 stdin이 비었음
+			break;
+		}
+	}
+	return bytes_read;
+}
+
+// 사용자 버퍼 buffer의 size 바이트를 fe에 쓰고 쓴 바이트 수를 반환
+// 사용자 버퍼를 COPY_CHUNK씩 커널 버퍼로 복사한 뒤 출력
+// buffer가 잘못된 주소라면 *fault를 true로 하고 멈춤 (호출자가 정리 후 종료)
+// ofs는 file_write_to()와 같음
+static unsigned write_user(struct file_elem *fe, const void *buffer, unsigned size, off_t *ofs,
+		bool *fault) {
+	char kbuf[COPY_CHUNK];
+	unsigned bytes_written = 0;
+	while (bytes_written < size) {
+		unsigned chunk = size - bytes_written < COPY_CHUNK ? size - bytes_written : COPY_CHUNK;
+		unsigned n;
+		void *kpage;
+
+		if (fe->file && (kpage = get_user_frame((void *) buffer + bytes_written, size - bytes_written, false))) {
+			// 사용자 프레임에서 바로 쓰기 (복사 없음)
+			chunk = PGSIZE;
+			n = file_write_to(fe, kpage, chunk, ofs);
+		} else {
+			if (!copy_from_user(kbuf, buffer + bytes_written, chunk)) {
+				*fault = true;
+				break;
+			}
+			n = write_kernel(fe, kbuf, chunk, ofs);
+		}
+
+		bytes_written += n;
+		if (n < chunk) {
+			// 파일을 더 늘릴 수 없거나 쓰기가 금지됨
+			break;
+		}
+	}
+	return bytes_written;
+}
+
+// fd에 해당하는 읽을 수 있는 file_elem을 반환, 없으면 NULL
+static struct file_elem *get_readable_fe(int fd) {
+	struct file_elem *fe = get_file_in_list(fd);
+	if (fe == NULL || fe->std_no == STDOUT_FILENO) {
+		// fd_table에 없거나 stdout에서 읽기: 에러
+		return NULL;
+	} else if (fe->pipe != NULL) {
+		// 파이프는 읽는 쪽만 읽을 수 있음
+		return fe->writer ? NULL : fe;
+	} else if (fe->std_no != STDIN_FILENO && fe->file == NULL) {
+		return NULL;
+	}
+	return fe;
+}
+
+// fd에 해당하는 쓸 수 있는 file_elem을 반환, 없으면 NULL
+static struct file_elem *get_writable_fe(int fd) {
+	struct file_elem *fe = get_file_in_list(fd);
+	if (fe == NULL || fe->std_no == STDIN_FILENO) {
+		// fd_table에 없거나 stdin으로 출력: 에러
+		return NULL;
+	} else if (fe->pipe != NULL) {
+		// 파이프는 쓰는 쪽만 쓸 수 있음
+		return fe->writer ? fe : NULL;
+	} else if (fe->std_no != STDOUT_FILENO && fe->file == NULL) {
+		return NULL;
+	}
+	return fe;
+}
+
 static int read(int fd, void *buffer, unsigned size) {
-	if (!is_valid_addr(buffer) || !is_valid_addr(buffer + size -1)) {
-		// buffer의 시작과 끝 주소를 확인
+	struct file_elem *fe = get_readable_fe(fd);
+	if (fe == NULL) {
+		return -1;
+	}
+	bool fault = false;
+	unsigned n = read_user(fe, buffer, size, NULL, false, &fault);
+	if (fault) {
 		exit(-1);
 	}
+	return n;
+}
 
-	struct file_elem *fe = get_file_in_list(fd);
+static int write(int fd, const void *buffer, unsigned size) {
+	struct file_elem *fe = get_writable_fe(fd);
 	if (fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
 		return -1;
 	}
+	bool fault = false;
+	unsigned n = write_user(fe, buffer, size, NULL, &fault);
+	if (fault) {
+		exit(-1);
+	}
+	if (n == 0 && size > 0 && fe->pipe != NULL) {
+		// 읽는 쪽이 모두 닫힌 파이프
+		return -1;
+	}
+	return n;
+}
 
-	if (fe->std_no == STDIN_FILENO) {
-		// stdin에서 읽기
-		for (unsigned i = 0; i < size; i++) {
-			*((uint8_t *) buffer + i) = input_getc();
-		}
-		return size;
-	} else if (fe->std_no == STDOUT_FILENO) {
-		// stdout에서 읽기: 에러
+// offset 위치에서 읽기, 파일의 현재 위치는 바뀌지 않음
+static int pread(int fd, void *buffer, unsigned size, off_t offset) {
+	struct file_elem *fe = get_readable_fe(fd);
+	if (fe == NULL || fe->file == NULL || offset < 0) {
+		// stdin은 위치가 없음
 		return -1;
 	}
-	
-	if (fe->file) {
-		// 파일에서 읽기
-		return file_read (fe->file, buffer, size);
-	} else {
+	bool fault = false;
+	unsigned n = read_user(fe, buffer, size, &offset, false, &fault);
+	if (fault) {
+		exit(-1);
+	}
+	return n;
+}
+
+// offset 위치에 쓰기, 파일의 현재 위치는 바뀌지 않음
+static int pwrite(int fd, const void *buffer, unsigned size, off_t offset) {
+	struct file_elem *fe = get_writable_fe(fd);
+	if (fe == NULL || fe->file == NULL || offset < 0) {
+		// stdout은 위치가 없음
 		return -1;
 	}
+	bool fault = false;
+	unsigned n = write_user(fe, buffer, size, &offset, &fault);
+	if (fault) {
+		exit(-1);
+	}
+	return n;
 }
 
-static int write(int fd, const void *buffer, unsigned size) {
-	if (!is_valid_addr(buffer) || !is_valid_addr(buffer + size -1)) {
-		// buffer의 시작과 끝 주소를 확인
+// fd_in에서 fd_out으로 최대 size 바이트를 커널 안에서 복사하고 복사한 바이트 수를 반환
+// uofs_in/uofs_out이 NULL이면 파일의 현재 위치를 사용하고, 아니면 그 위치에서
+// 읽고 쓴 뒤 사용자 변수를 전진시킴 (이때 파일의 현재 위치는 바뀌지 않음)
+static int copy_file_range(int fd_in, off_t *uofs_in, int fd_out, off_t *uofs_out,
+		unsigned size) {
+	struct file_elem *fe_in = get_readable_fe(fd_in);
+	struct file_elem *fe_out = get_writable_fe(fd_out);
+	off_t ofs_in, ofs_out;
+
+	if (fe_in == NULL || fe_out == NULL || fe_in->pipe != NULL || fe_out->pipe != NULL) {
+		// 파이프는 지원하지 않음
+		return -1;
+	}
+	if (uofs_in != NULL) {
+		if (!copy_from_user(&ofs_in, uofs_in, sizeof ofs_in)) {
+			exit(-1);
+		}
+		if (fe_in->file == NULL || ofs_in < 0) {
+			// stdin은 위치가 없음
+			return -1;
+		}
+	}
+	if (uofs_out != NULL) {
+		if (!copy_from_user(&ofs_out, uofs_out, sizeof ofs_out)) {
+			exit(-1);
+		}
+		if (fe_out->file == NULL || ofs_out < 0) {
+			// stdout은 위치가 없음
+			return -1;
+		}
+	}
+	if (size > INT32_MAX) {
+		size = INT32_MAX;
+	}
+
+	char *kpage = palloc_get_page(0);
+	if (kpage == NULL) {
+		return -1;
+	}
+
+	// 한 페이지씩 읽어서 바로 씀, 사용자 메모리를 거치지 않음
+	unsigned bytes_copied = 0;
+	while (bytes_copied < size) {
+		unsigned chunk = size - bytes_copied < PGSIZE ? size - bytes_copied : PGSIZE;
+		unsigned n = read_kernel(fe_in, kpage, chunk, uofs_in ? &ofs_in : NULL);
+		unsigned m = n > 0 ? write_kernel(fe_out, kpage, n, uofs_out ? &ofs_out : NULL) : 0;
+
+		bytes_copied += m;
+		if (m < n && uofs_in != NULL) {
+			ofs_in -= n - m;
+		} else if (m < n && fe_in->file != NULL) {
+			// 쓰지 못한 만큼 입력 파일의 위치를 되돌림
+			file_seek(fe_in->file, file_tell(fe_in->file) - (n - m));
+		}
+		if (n < chunk || m < n) {
+			break;
+		}
+	}
+	palloc_free_page(kpage);
+
+	if ((uofs_in != NULL && !copy_to_user(uofs_in, &ofs_in, sizeof ofs_in))
+			|| (uofs_out != NULL && !copy_to_user(uofs_out, &ofs_out, sizeof ofs_out))) {
 		exit(-1);
 	}
+	return bytes_copied;
+}
 
-	struct file_elem *fe = get_file_in_list(fd);
+// 사용자의 iovec 배열을 커널로 복사하고, 메모리상 이어진 segment는 하나로 합침
+// 합친 뒤의 segment 수를 *cnt에, 전체 길이를 *total에 저장
+// iovcnt가 잘못되었거나 전체 길이가 int 범위를 넘으면 NULL 반환 (호출자가 free)
+static struct iovec *get_user_iov(const struct iovec *uiov, int iovcnt,
+		int *cnt, size_t *total) {
+	if (iovcnt <= 0 || iovcnt > IOV_MAX) {
+		return NULL;
+	}
+
+	struct iovec *iov = malloc(iovcnt * sizeof(*iov));
+	if (iov == NULL) {
+		return NULL;
+	}
+	if (!copy_from_user(iov, uiov, iovcnt * sizeof(*iov))) {
+		free(iov);
+		exit(-1);
+	}
+
+	int n = 0;
+	*total = 0;
+	for (int i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len > INT32_MAX - *total) {
+			free(iov);
+			return NULL;
+		}
+		*total += iov[i].iov_len;
+		if (iov[i].iov_len == 0) {
+			continue;
+		}
+		if (n > 0 && iov[n - 1].iov_base + iov[n - 1].iov_len == iov[i].iov_base) {
+			iov[n - 1].iov_len += iov[i].iov_len;
+		} else {
+			iov[n++] = iov[i];
+		}
+	}
+	*cnt = n;
+	return iov;
+}
+
+// iovcnt개의 segment로 흩어진 사용자 버퍼로 읽음
+// 한 페이지보다 작은 segment들은 한 번의 읽기로 커널 페이지에 모은 뒤 나눠 복사
+static int readv(int fd, const struct iovec *uiov, int iovcnt) {
+	struct file_elem *fe = get_readable_fe(fd);
 	if (fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
 		return -1;
 	}
+	if (iovcnt == 0) {
+		return 0;
+	}
 
-	if (fe->std_no == STDIN_FILENO) {
-		// stdin으로 출력: 에러
+	int cnt;
+	size_t total;
+	struct iovec *iov = get_user_iov(uiov, iovcnt, &cnt, &total);
+	if (iov == NULL) {
 		return -1;
-	} else if (fe->std_no == STDOUT_FILENO) {
-		// stdout으로 출력
-		// thread_yield(); //////////////////////
-		// printf("[DBG] syscall write(): {%s} is now talking\n", thread_current()->name); ///////////
-		unsigned bytes_left = size;
-		unsigned bytes_to_write;
-		void *p = buffer;
-		while (bytes_left > 0) {
-			bytes_to_write = bytes_left < PUTBUF_MAX ? bytes_left : PUTBUF_MAX; // min(bytes_left, PUTBUF_MAX)
-			putbuf(p, bytes_to_write);
-			p += bytes_to_write;
-			bytes_left -= bytes_to_write;
+	}
+	char *kpage = palloc_get_page(0);
+	if (kpage == NULL) {
+		free(iov);
+		return -1;
+	}
+
+	unsigned bytes_read = 0;
+	int i = 0;
+	while (i < cnt) {
+		if (iov[i].iov_len >= PGSIZE) {
+			// 큰 segment는 바로 읽음
+			bool fault = false;
+			unsigned n = read_user(fe, iov[i].iov_base, iov[i].iov_len, NULL,
+					bytes_read > 0, &fault);
+			if (fault) {
+				palloc_free_page(kpage);
+				free(iov);
+				exit(-1);
+			}
+			bytes_read += n;
+			if (n < iov[i].iov_len) {
+				break;
+			}
+			i++;
+			continue;
+		}
+
+		// 한 페이지에 들어가는 만큼 이어지는 작은 segment들을 한 번에 읽음
+		unsigned want = 0;
+		int j;
+		for (j = i; j < cnt && want + iov[j].iov_len <= PGSIZE; j++) {
+			want += iov[j].iov_len;
+		}
+		// 앞 segment에서 읽은 데이터가 있으면 파이프와 stdin에서 기다리지 않음
+		unsigned n = read_kernel_more(fe, kpage, want, NULL, bytes_read > 0);
+		unsigned ofs = 0;
+		for (; i < j && ofs < n; i++) {
+			unsigned len = n - ofs < iov[i].iov_len ? n - ofs : iov[i].iov_len;
+			if (!copy_to_user(iov[i].iov_base, kpage + ofs, len)) {
+				palloc_free_page(kpage);
+				free(iov);
+				exit(-1);
+			}
+			ofs += len;
+		}
+		bytes_read += n;
+		if (n < want) {
+			break;
 		}
-		return size;
 	}
-	
-	if (fe->file) {
-		// 파일에 쓰기
-		return file_write (fe->file, buffer, size);
-	} else {
+
+	palloc_free_page(kpage);
+	free(iov);
+	return bytes_read;
+}
+
+// iovcnt개의 segment로 흩어진 사용자 버퍼를 씀
+// 한 페이지보다 작은 segment들은 커널 페이지에 모아 한 번에 씀
+static int writev(int fd, const struct iovec *uiov, int iovcnt) {
+	struct file_elem *fe = get_writable_fe(fd);
+	if (fe == NULL) {
+		return -1;
+	}
+	if (iovcnt == 0) {
+		return 0;
+	}
+
+	int cnt;
+	size_t total;
+	struct iovec *iov = get_user_iov(uiov, iovcnt, &cnt, &total);
+	if (iov == NULL) {
 		return -1;
 	}
+	char *kpage = palloc_get_page(0);
+	if (kpage == NULL) {
+		free(iov);
+		return -1;
+	}
+
+	unsigned bytes_written = 0;
+	unsigned used = 0; // kpage에 모아둔 바이트 수
+	bool short_write = false;
+	for (int i = 0; i < cnt && !short_write; i++) {
+		if (iov[i].iov_len >= PGSIZE) {
+			// 모아둔 내용을 먼저 쓴 뒤 큰 segment는 바로 씀
+			if (used > 0) {
+				unsigned n = write_kernel(fe, kpage, used, NULL);
+				bytes_written += n;
+				short_write = n < used;
+				used = 0;
+				if (short_write) {
+					break;
+				}
+			}
+			bool fault = false;
+			unsigned n = write_user(fe, iov[i].iov_base, iov[i].iov_len, NULL, &fault);
+			if (fault) {
+				palloc_free_page(kpage);
+				free(iov);
+				exit(-1);
+			}
+			bytes_written += n;
+			short_write = n < iov[i].iov_len;
+			continue;
+		}
+
+		if (used + iov[i].iov_len > PGSIZE) {
+			unsigned n = write_kernel(fe, kpage, used, NULL);
+			bytes_written += n;
+			short_write = n < used;
+			used = 0;
+			if (short_write) {
+				break;
+			}
+		}
+		if (!copy_from_user(kpage + used, iov[i].iov_base, iov[i].iov_len)) {
+			palloc_free_page(kpage);
+			free(iov);
+			exit(-1);
+		}
+		used += iov[i].iov_len;
+	}
+	if (used > 0 && !short_write) {
+		bytes_written += write_kernel(fe, kpage, used, NULL);
+	}
+
+	palloc_free_page(kpage);
+	free(iov);
+	return bytes_written;
 }
 
 static void seek(int fd, unsigned position) {
 	struct file_elem *fe = get_file_in_list(fd);
 	if (fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
+		// fd에 해당하는 파일이 fd_table에 없음
 		return;
 	}
 
@@ -396,7 +901,7 @@ static void seek(int fd, unsigned position) {
 static unsigned tell(int fd) {
 	struct file_elem *fe = get_file_in_list(fd);
 	if (fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
+		// fd에 해당하는 파일이 fd_table에 없음
 		return 0;
 	}
 
@@ -412,71 +917,312 @@ static unsigned tell(int fd) {
 }
 
 static void close(int fd) {
-	struct file_elem *fe = get_file_in_list(fd);
+	struct file_elem *fe = thread_remove_fe(fd);
 
 	if (fe == NULL) {
 		// fd에 해당하는 요소가 없음
 		exit(-1);
 	}
 
-	// file이 NULL이면 복사된 fd에 의해 이미 닫힌 파일
+	// dup2로 복사된 fd가 남아있으면 파일은 열린 채로 유지됨
+	thread_put_fe(fe);
+}
+
+// P2-E
+int dup2(int oldfd, int newfd) {
+	if (!thread_dup_fe(oldfd, newfd)) {
+		// fd에 해당하는 파일이 fd_table에 없거나 newfd를 등록할 수 없음
+		return -1;
+	}
+	return newfd;
+}
 
-	if (fe->file != NULL) {
-		// 이미 닫힌 파일이 아닌 경우
-		struct list *file_list = &thread_current()->file_list;
-		struct list_elem *e;
-		struct file_elem *dup_fe;
+// 파이프를 만들고 읽는 쪽의 fd를 fds[0]에, 쓰는 쪽의 fd를 fds[1]에 저장
+static int pipe(int *ufds) {
+	struct pipe *p = pipe_create();
+	if (p == NULL) {
+		return -1;
+	}
+
+	int fds[2];
+	fds[0] = add_pipe_in_list(p, false);
+	if (fds[0] < 0) {
+		pipe_close(p, true);
+		return -1;
+	}
+	fds[1] = add_pipe_in_list(p, true);
+	if (fds[1] < 0) {
+		thread_put_fe(thread_remove_fe(fds[0]));
+		return -1;
+	}
+
+	if (!copy_to_user(ufds, fds, sizeof fds)) {
+		// 만든 fd들은 exit에서 닫힘
+		exit(-1);
+	}
+	return 0;
+}
 
-		// 복사된 fd를 모두 찾아 file을 NULL로 변경
-		for (e = list_begin(file_list); e != list_end(file_list); e = list_next(e)) {
-			dup_fe = list_entry(e, struct file_elem, elem);
-			if (dup_fe->file == fe->file) {
-				dup_fe->file = NULL;
+// sqe 하나를 해당 시스템 콜로 실행하고 그 결과를 반환, 알 수 없는 op이면 -1
+static int64_t uring_run(const struct uring_sqe *sqe) {
+	void *addr = (void *) sqe->addr;
+
+	switch (sqe->op) {
+		case URING_OP_NOP:
+			return 0;
+		case URING_OP_READ:
+			return read(sqe->fd, addr, sqe->len);
+		case URING_OP_WRITE:
+			return write(sqe->fd, addr, sqe->len);
+		case URING_OP_PREAD:
+			return pread(sqe->fd, addr, sqe->len, sqe->off);
+		case URING_OP_PWRITE:
+			return pwrite(sqe->fd, addr, sqe->len, sqe->off);
+		case URING_OP_OPEN:
+			return open(addr);
+		case URING_OP_CLOSE: {
+			// close()와 달리 잘못된 fd에도 종료하지 않고 -1을 돌려줌
+			struct file_elem *fe = thread_remove_fe(sqe->fd);
+			if (fe == NULL) {
+				return -1;
 			}
+			thread_put_fe(fe);
+			return 0;
 		}
+		default:
+			return -1;
 	}
-
-	file_close(fe->file);
-	list_remove(&fe->elem);
-	free(fe);
-	// palloc_free_page(fe);
 }
 
-// P2-E
-int dup2(int oldfd, int newfd) {
-	// return 2; //////////////////////////////////////////// 불구만들기 ////////////////////////////////////////
-	struct file_elem *old_fe = get_file_in_list(oldfd);
-	if (old_fe == NULL) {
-		// fd에 해당하는 파일이 file_list에 없음
+// 사용자 페이지 uring의 submission ring에서 최대 to_submit개의 sqe를 순서대로 실행하고
+// 각 결과를 completion ring에 cqe로 기록, 실행한 sqe 수를 반환
+// ring은 커널이 프레임을 통해 직접 읽고 쓰므로 sqe마다 사용자 메모리를 복사하지 않음
+// completion ring이 가득 차면 그 자리에서 멈춤, ring이 잘못되었으면 -1 반환
+static int uring_enter(struct uring *uring, unsigned to_submit) {
+	if (pg_ofs(uring) != 0 || !is_user_vaddr(uring)) {
 		return -1;
 	}
+	struct uring *r = pml4_get_user_page(thread_current()->pml4, uring, true);
+	if (r == NULL) {
+		return -1;
+	}
+
+	uint32_t sq_head = r->sq_head;
+	uint32_t sq_tail = r->sq_tail;
+	uint32_t cq_tail = r->cq_tail;
+	barrier(); // sq_tail을 읽은 뒤에 sqe를 읽음
+	if (sq_tail - sq_head > URING_SQ_ENTRIES) {
+		return -1;
+	}
+	if (to_submit > sq_tail - sq_head) {
+		to_submit = sq_tail - sq_head;
+	}
 
-	if (oldfd == newfd) {
-		return newfd;
+	unsigned done;
+	for (done = 0; done < to_submit; done++) {
+		if (cq_tail - r->cq_head >= URING_CQ_ENTRIES) {
+			// completion ring이 가득 참
+			break;
+		}
+
+		// 실행 중에 사용자가 바꾸지 못하도록 sqe를 복사해 둠
+		struct uring_sqe sqe = r->sqes[sq_head % URING_SQ_ENTRIES];
+		r->sq_head = ++sq_head;
+
+		struct uring_cqe *cqe = &r->cqes[cq_tail % URING_CQ_ENTRIES];
+		int64_t res = uring_run(&sqe);
+		cqe->user_data = sqe.user_data;
+		cqe->res = res;
+		barrier(); // cqe를 채운 뒤에 cq_tail을 전진
+		r->cq_tail = ++cq_tail;
 	}
+	return done;
+}
 
-	struct file_elem *new_fe = get_file_in_list(newfd);
+// fe에서 events 중 지금 준비된 것과 항상 보고하는 POLLERR, POLLHUP, POLLNVAL을 반환
+// 일반 파일은 언제나 읽고 쓸 수 있음
+static short poll_fe(struct file_elem *fe, short events) {
+	short revents;
 
-	if (new_fe == NULL) {
-		// newfd가 기존에 존재하지 않음: oldfd를 복사한 새로운 newfd를 생성
-		struct list *file_list = &thread_current()->file_list;
-		new_fe = malloc(sizeof(*new_fe));
-		// new_fe = palloc_get_page(PAL_USER);
-		new_fe->fd = newfd;
-		new_fe->file = old_fe->file;
-		new_fe->std_no = old_fe->std_no;
-		list_insert_ordered(file_list, &new_fe->elem, file_elem_fd_less, NULL);
+	if (fe == NULL) {
+		return POLLNVAL;
+	} else if (fe->pipe != NULL) {
+		revents = pipe_poll(fe->pipe, fe->writer);
+	} else if (fe->std_no == STDIN_FILENO) {
+		revents = stdin_ready() ? POLLIN : 0;
+	} else if (fe->std_no == STDOUT_FILENO) {
+		revents = POLLOUT;
 	} else {
-		// newfd가 이미 존재: 기존 파일을 닫고 oldfd를 복사
-		file_close(new_fe->file);
-		new_fe->file = old_fe->file;
-		new_fe->std_no = old_fe->std_no;
+		revents = POLLIN | POLLOUT;
 	}
+	return revents & (events | POLLERR | POLLHUP | POLLNVAL);
+}
 
-	return new_fe->fd;
+// fds의 nfds개 fd 중 하나라도 준비되거나 timeout ms가 지날 때까지 기다림
+// timeout이 음수면 제한 없이, 0이면 기다리지 않음
+// 각 revents를 채우고 준비된 fd의 수를 반환, 실패 시 -1 반환
+static int poll(struct pollfd *ufds, unsigned nfds, int timeout) {
+	if (nfds > FD_MAX) {
+		return -1;
+	}
+	// nfds가 0이면 timeout 동안 잠들기만 함, malloc(0)은 NULL이므로 1바이트 더 할당
+	struct pollfd *fds = malloc(nfds * sizeof(*fds) + 1);
+	if (fds == NULL) {
+		return -1;
+	}
+	if (!copy_from_user(fds, ufds, nfds * sizeof(*fds))) {
+		free(fds);
+		exit(-1);
+	}
+
+	int64_t wake_tick = INT64_MAX;
+	if (timeout >= 0) {
+		wake_tick = timer_ticks() + ((int64_t) timeout * TIMER_FREQ + 999) / 1000;
+	}
+
+	int ready;
+	for (;;) {
+		// 준비 상태를 확인하기 전에 이벤트 번호를 읽어 그 사이의 이벤트를 놓치지 않음
+		uint64_t seq = thread_poll_seq();
+
+		ready = 0;
+		for (unsigned i = 0; i < nfds; i++) {
+			fds[i].revents = 0;
+			if (fds[i].fd >= 0) {
+				fds[i].revents = poll_fe(get_file_in_list(fds[i].fd), fds[i].events);
+			}
+			if (fds[i].revents != 0) {
+				ready++;
+			}
+		}
+		if (ready > 0 || timer_ticks() >= wake_tick) {
+			break;
+		}
+		timer_poll_wait(seq, wake_tick);
+	}
+
+	if (!copy_to_user(ufds, fds, nfds * sizeof(*fds))) {
+		free(fds);
+		exit(-1);
+	}
+	free(fds);
+	return ready;
 }
 
+// 커널 메모리와 현재 프로세스의 메모리 사용량을 ms에 기록
+static bool memstat(struct memstat *ms) {
+	struct memstat kms;
+	palloc_memstat(&kms);
+	malloc_memstat(&kms);
+	pml4_count_pages(thread_current()->pml4, &kms.rss, &kms.pt_pages);
 
+	if (!copy_to_user(ms, &kms, sizeof(kms))) {
+		exit(-1);
+	}
+	return true;
+}
+
+// 현재 프로세스의 시스템 콜 nr 통계를 st에 기록, nr이 잘못된 번호면 false 반환
+static bool sysstat(int nr, struct sysstat *st) {
+	struct sysstat kst;
+
+	if (nr < 0 || nr >= SYS_CNT)
+		return false;
+
+	struct sysstat *stats = thread_current()->sysstats;
+	if (stats != NULL)
+		kst = stats[nr];
+	else
+		memset(&kst, 0, sizeof kst);
+
+	if (!copy_to_user(st, &kst, sizeof kst)) {
+		exit(-1);
+	}
+	return true;
+}
+
+// 시스템 콜 nr의 통계 칸을 반환, 처음 호출될 때 프로세스의 통계 배열을 할당
+// 번호가 잘못됐거나 메모리가 없으면 NULL (통계 없이 계속 진행)
+static struct sysstat *get_sysstat(int nr) {
+	struct thread *curr = thread_current();
+
+	if (nr < 0 || nr >= SYS_CNT)
+		return NULL;
+	if (curr->sysstats == NULL) {
+		curr->sysstats = calloc(SYS_CNT, sizeof *curr->sysstats);
+		if (curr->sysstats == NULL)
+			return NULL;
+	}
+	return &curr->sysstats[nr];
+}
+
+// 시스템 콜 한 번의 지연 시간(cycles)과 오류 여부를 st에 누적
+static void account_sysstat(struct sysstat *st, uint64_t cycles, bool error) {
+	int bucket = cycles > 0 ? 63 - __builtin_clzll(cycles) : 0;
+
+	if (bucket >= SYSSTAT_BUCKETS)
+		bucket = SYSSTAT_BUCKETS - 1;
+	st->errors += error;
+	st->total_cycles += cycles;
+	if (cycles > st->max_cycles)
+		st->max_cycles = cycles;
+	st->hist[bucket]++;
+}
+
+// 종료하는 프로세스의 시스템 콜 통계를 (-sc 옵션이면) 출력하고 해제
+void syscall_release_stats(void) {
+	struct thread *curr = thread_current();
+	struct sysstat *stats = curr->sysstats;
+
+	if (stats == NULL)
+		return;
+	if (syscall_print_stats) {
+		printf("%s: system calls:\n", curr->name);
+		printf("  %-16s %8s %8s %12s %12s\n", "name", "calls", "errors",
+				"avg cycles", "max cycles");
+		for (int nr = 0; nr < SYS_CNT; nr++) {
+			struct sysstat *st = &stats[nr];
+			uint64_t timed = 0;
+
+			if (st->calls == 0)
+				continue;
+			for (int i = 0; i < SYSSTAT_BUCKETS; i++)
+				timed += st->hist[i];
+			printf("  %-16s %8llu %8llu %12llu %12llu\n", syscall_names[nr],
+					st->calls, st->errors,
+					timed > 0 ? st->total_cycles / timed : 0, st->max_cycles);
+
+			// 0이 아닌 히스토그램 칸만 "2^i:개수" 형태로 출력
+			if (timed > 0) {
+				printf("  %-16s", "");
+				for (int i = 0; i < SYSSTAT_BUCKETS; i++)
+					if (st->hist[i] > 0)
+						printf(" 2^%d:%u", i, st->hist[i]);
+				printf("\n");
+			}
+		}
+	}
+	curr->sysstats = NULL;
+	free(stats);
+}
+
+// 커널 로그의 최근 내용을 최대 size 바이트까지 buffer에 복사하고 복사한 바이트 수를 반환
+static int dmesg(char *buffer, unsigned size) {
+	// 로그는 인터럽트를 끈 채로 복사하므로 커널 버퍼를 거침
+	if (size > CONSOLE_LOG_SIZE)
+		size = CONSOLE_LOG_SIZE;
+	char *kbuf = vmalloc(size);
+	if (kbuf == NULL)
+		return -1;
+
+	size_t len = console_read_log(kbuf, size);
+	if (!copy_to_user(buffer, kbuf, len)) {
+		vfree(kbuf);
+		exit(-1);
+	}
+	vfree(kbuf);
+	return len;
+}
 
 /* The main system call interface */
 void
@@ -493,6 +1239,12 @@ syscall_handler (struct intr_frame *f) {
 
 	tid_t ttt; /////////////////////////////////////////////
 
+	// 호출 횟수는 돌아오지 않는 시스템 콜(exit 등)도 세도록 먼저 증가
+	struct sysstat *st = get_sysstat(syscall_no);
+	if (st != NULL)
+		st->calls++;
+	uint64_t start_tsc = rdtsc();
+
 	switch (syscall_no) {
 		/* Projects 2 and later. */
 		case SYS_HALT: /* Halt the operating system. */
@@ -584,10 +1336,48 @@ syscall_handler (struct intr_frame *f) {
 		case SYS_UMOUNT:
 			printf("syscall_handler(): not implemented (rax = %d)\n", syscall_no);
 			break;
+		case SYS_MEMSTAT: /* Report kernel and process memory usage. */
+			ret = (uint64_t) memstat(arg1);
+			break;
+		case SYS_DMESG: /* Read the kernel log. */
+			ret = (uint64_t) dmesg(arg1, (unsigned) (uint64_t) arg2);
+			break;
+		case SYS_READV: /* Read into several buffers. */
+			ret = (uint64_t) readv((int) (uint64_t) arg1, arg2, (int) (uint64_t) arg3);
+			break;
+		case SYS_WRITEV: /* Write from several buffers. */
+			ret = (uint64_t) writev((int) (uint64_t) arg1, arg2, (int) (uint64_t) arg3);
+			break;
+		case SYS_PREAD: /* Read from a file at an offset. */
+			ret = (uint64_t) pread((int) (uint64_t) arg1, arg2, (unsigned) (uint64_t) arg3, (off_t) (uint64_t) arg4);
+			break;
+		case SYS_PWRITE: /* Write to a file at an offset. */
+			ret = (uint64_t) pwrite((int) (uint64_t) arg1, arg2, (unsigned) (uint64_t) arg3, (off_t) (uint64_t) arg4);
+			break;
+		case SYS_COPY_FILE_RANGE: /* Copy data between files. */
+			ret = (uint64_t) copy_file_range((int) (uint64_t) arg1, arg2, (int) (uint64_t) arg3, arg4, (unsigned) (uint64_t) arg5);
+			break;
+		case SYS_PIPE: /* Create a pipe. */
+			ret = (uint64_t) pipe(arg1);
+			break;
+		case SYS_URING_ENTER: /* Run queued I/O operations. */
+			ret = (uint64_t) uring_enter(arg1, (unsigned) (uint64_t) arg2);
+			break;
+		case SYS_POLL: /* Wait for descriptors to become ready. */
+			ret = (uint64_t) poll(arg1, (unsigned) (uint64_t) arg2, (int) (uint64_t) arg3);
+			break;
+		case SYS_SPAWN: /* Start a new process from a program file. */
+			ret = (uint64_t) spawn(arg1, arg2, (int) (uint64_t) arg3);
+			break;
+		case SYS_SYSSTAT: /* Report per-system-call statistics. */
+			ret = (uint64_t) sysstat((int) (uint64_t) arg1, arg2);
+			break;
 		default:
 			printf("syscall_handler(): unknown request (rax = %d)\n", syscall_no);
 	}
 
+	if (st != NULL)
+		account_sysstat(st, rdtsc() - start_tsc, (int64_t) ret < 0);
 	f->R.rax = ret;
 
 	// do_iret(f);
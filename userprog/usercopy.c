@@ -0,0 +1,51 @@
+#include "userprog/usercopy.h"
+#include "threads/vaddr.h"
+
+/* Copy loops in usercopy-loops.S. */
+size_t usercopy_copy (void *dst, const void *src, size_t size);
+int64_t usercopy_strncpy (char *dst, const char *src, size_t size);
+
+/* Returns true if the SIZE bytes starting at UADDR all lie
+   below KERN_BASE, false otherwise. */
+static bool
+is_user_range (const void *uaddr, size_t size) {
+	uint64_t start = (uint64_t) uaddr;
+
+	return start + size >= start && start + size <= KERN_BASE;
+}
+
+/* Copies SIZE bytes from user address USRC to DST.  Returns true
+   if successful, false if some byte of USRC could not be read,
+   in which case DST may have been partly written. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) {
+	return is_user_range (usrc, size) && usercopy_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from SRC to user address UDST.  Returns true
+   if successful, false if some byte of UDST could not be
+   written, in which case UDST may have been partly written. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) {
+	return is_user_range (udst, size) && usercopy_copy (udst, src, size) == 0;
+}
+
+/* Copies the string at user address USRC into DST, which has
+   room for SIZE bytes.  Returns the string's length if it fit,
+   with DST null-terminated.  Returns SIZE if the string did not
+   fit, in which case DST is not null-terminated, or -1 if USRC
+   could not be read. */
+int64_t
+strncpy_from_user (char *dst, const char *usrc, size_t size) {
+	uint64_t start = (uint64_t) usrc;
+
+	if (start >= KERN_BASE)
+		return -1;
+	/* Stop at the top of user space; a string that runs into it
+	   is unterminated as far as the user can see. */
+	if (size > KERN_BASE - start) {
+		int64_t len = usercopy_strncpy (dst, usrc, KERN_BASE - start);
+		return len == (int64_t) (KERN_BASE - start) ? -1 : len;
+	}
+	return usercopy_strncpy (dst, usrc, size);
+}